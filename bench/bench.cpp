@@ -0,0 +1,280 @@
+/**
+ * @file bench.cpp
+ * @author EA
+ *
+ * Benchmarks of construction, persistence, queries and updates, with repeatable timings.
+ * Each benchmark is run on a fixed seed, so two versions can be compared on the same graph and queries.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <getopt.h>
+
+#include "type_definitions.hpp"
+#include "compress.hpp"
+#include "parse.hpp"
+#include "read.hpp"
+#include "modify.hpp"
+#include "generator.hpp"
+
+using namespace std;
+
+// used to convert the default values to a string
+#define STRINGIFY( x) #x
+#define STR(x) STRINGIFY(x)
+
+#define DEFAULT_REPETITIONS 5
+#define DEFAULT_QUERIES 1000
+#define DEFAULT_UPDATES 20
+#define MAX_QUERY_SIZE 4
+
+static void print_usage() {
+    static const char* usage_str = \
+    "Usage: hypercsa-bench\n"
+    "-h                                      show this help\n"
+    "-i [input]                              benchmark on the hypergraph file, one edge per line\n"
+    "-g [nodes],[edges],[max size]           benchmark on a uniform random hypergraph instead, see hypercsa-generate\n"
+    "-s [seed]                               seed of the generated graph and the queries, default 1\n"
+    "-r [repetitions]                        repetitions of parse, construct and load, default " STR(DEFAULT_REPETITIONS) "\n"
+    "-q [queries]                            queries per type and size, default " STR(DEFAULT_QUERIES) "\n"
+    "-u [updates]                            updates per modify operation, default " STR(DEFAULT_UPDATES) "\n"
+    "-o [file]                               temporary .hcsa file for the load benchmark, default hypercsa-bench.hcsa\n"
+    ;
+    fprintf(stderr, "%s", usage_str);
+}
+
+class Measurement {
+public:
+    string name;
+    vector<double> ms; // One sample per operation.
+    uint64_t items = 0; // Items processed by all samples, e.g. incidences or results.
+
+    explicit Measurement(string name) : name(std::move(name)) {}
+
+    double total() const {
+        double sum = 0;
+        for (double m : ms)
+            sum += m;
+        return sum;
+    }
+
+    double percentile(double p) const {
+        if (ms.empty())
+            return 0;
+        vector<double> sorted = ms;
+        sort(sorted.begin(), sorted.end());
+        return sorted[min(sorted.size() - 1, (size_t) (p * sorted.size()))];
+    }
+};
+
+static void print_header() {
+    printf("%-36s %10s %12s %12s %12s %12s %14s\n", "Benchmark", "Iterations", "Mean ms", "p50 ms", "p90 ms", "p99 ms", "Items/s");
+    printf("%s\n", string(112, '-').c_str());
+}
+
+static void print_measurement(const Measurement &m) {
+    double mean = m.ms.empty() ? 0 : m.total() / m.ms.size();
+    double throughput = m.total() > 0 ? m.items / (m.total() / 1000.0) : 0;
+    printf("%-36s %10zu %12.4f %12.4f %12.4f %12.4f %14.0f\n", m.name.c_str(), m.ms.size(), mean,
+           m.percentile(0.5), m.percentile(0.9), m.percentile(0.99), throughput);
+}
+
+template<class F>
+static double time_ms(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Exact queries are existing edges, contains queries random subsets of existing edges.
+static vector<Edge> sample_queries(const HyperGraph &graph, int type, uint64_t size, uint64_t count, mt19937_64 &random) {
+    vector<Edge> queries;
+    vector<const Edge *> candidates;
+    for (const Edge &e : graph.edges)
+        if (type == EXACT ? e.size() == size : e.size() >= size)
+            candidates.push_back(&e);
+    if (candidates.empty())
+        return queries;
+    for (uint64_t i = 0; i < count; i++) {
+        const Edge &e = *candidates[random() % candidates.size()];
+        vector<Node> nodes(e.begin(), e.end());
+        shuffle(nodes.begin(), nodes.end(), random);
+        Edge q(size);
+        copy(nodes.begin(), nodes.begin() + size, q.begin());
+        queries.push_back(q);
+    }
+    return queries;
+}
+
+int main(int argc, char** argv) {
+    string input_file, output_file = "hypercsa-bench.hcsa";
+    uint64_t nodes = 0, edges = 0, max_size = 0, seed = 1;
+    int repetitions = DEFAULT_REPETITIONS;
+    uint64_t query_count = DEFAULT_QUERIES, update_count = DEFAULT_UPDATES;
+    int opt;
+    while ((opt = getopt(argc, argv, "hi:g:s:r:q:u:o:")) != -1) {
+        switch (opt) {
+            case 'i':
+                input_file = optarg;
+                break;
+            case 'g':
+                if (sscanf(optarg, "%lu,%lu,%lu", &nodes, &edges, &max_size) != 3 || nodes == 0 || edges == 0 || max_size == 0) {
+                    fprintf(stderr, "Invalid graph parameters.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                seed = stoull(optarg);
+                break;
+            case 'r':
+                repetitions = max(1, stoi(optarg));
+                break;
+            case 'q':
+                query_count = stoull(optarg);
+                break;
+            case 'u':
+                update_count = stoull(optarg);
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'h':
+            default:
+                print_usage();
+                return 0;
+        }
+    }
+    if (input_file.empty() == (edges == 0)) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    mt19937_64 random(seed);
+    vector<Measurement> results;
+    HyperGraph graph;
+
+    // Parse
+    if (!input_file.empty()) {
+        Measurement m{"parse"};
+        for (int r = 0; r < repetitions; r++) {
+            HyperGraph parsed;
+            m.ms.push_back(time_ms([&]() { parse_graph(input_file.c_str(), parsed, true); }));
+            m.items += parsed.edge_count;
+            if (r == 0)
+                graph = parsed;
+        }
+        results.push_back(m);
+    } else {
+        GeneratorConfig config;
+        config.nodes = nodes;
+        config.edges = edges;
+        config.max_size = max_size;
+        config.seed = seed;
+        graph = generate_hypergraph(config);
+    }
+    uint64_t incidences = 0;
+    for (const Edge &e : graph.edges)
+        incidences += e.size();
+
+    // Construct, with its phases.
+    Measurement construct_total{"construct"};
+    vector<Measurement> construct_phases;
+    CompressedHyperGraph compressed({}, {});
+    for (int r = 0; r < repetitions; r++) {
+        HyperGraph copy = graph; // construct sorts the edges.
+        PhaseTimes phases;
+        construct_total.ms.push_back(time_ms([&]() { compressed = construct(copy, &phases); }));
+        construct_total.items += incidences;
+        for (size_t p = 0; p < phases.size(); p++) {
+            if (construct_phases.size() <= p)
+                construct_phases.emplace_back("construct/" + phases[p].first);
+            construct_phases[p].ms.push_back(phases[p].second);
+            construct_phases[p].items += incidences;
+        }
+    }
+    results.push_back(construct_total);
+    results.insert(results.end(), construct_phases.begin(), construct_phases.end());
+
+    // Write and load
+    Measurement write_m{"write"}, load_m{"load"};
+    for (int r = 0; r < repetitions; r++) {
+        write_m.ms.push_back(time_ms([&]() { write_hyper_csa(output_file.c_str(), compressed); }));
+        write_m.items += incidences;
+        load_m.ms.push_back(time_ms([&]() { CompressedHyperGraph loaded = load_hyper_csa(output_file.c_str()); }));
+        load_m.items += incidences;
+    }
+    uint64_t bytes = ifstream(output_file, ios::binary | ios::ate).tellg(); // What is persisted, not only D and PSI.
+    remove(output_file.c_str());
+    results.push_back(write_m);
+    results.push_back(load_m);
+
+    // Queries, items are the results.
+    PreparedHyperGraph prepared(compressed);
+    FlatEdgeList<uint64_t> result;
+    for (int type : {EXACT, CONTAIN}) {
+        for (uint64_t size = 1; size <= MAX_QUERY_SIZE; size++) {
+            vector<Edge> queries = sample_queries(graph, type, size, query_count, random);
+            if (queries.empty())
+                continue;
+            Measurement m{string(type == EXACT ? "query/exact/" : "query/contains/") + to_string(size)};
+            for (Edge &q : queries) {
+                result.clear();
+                m.ms.push_back(time_ms([&]() { query(prepared, q, type, result); }));
+                m.items += result.size();
+            }
+            results.push_back(m);
+        }
+    }
+
+    // Updates, each on its own copy so they do not influence each other.
+    Index position_count = compressed.PSI.size();
+    Measurement insert_edge_m{"modify/insert_edge"}, delete_edge_m{"modify/delete_edge"},
+            insert_node_m{"modify/insert_node_to_edge"}, delete_node_m{"modify/delete_node_from_edge"};
+    Node node_count = prepared.nodes;
+    for (uint64_t u = 0; u < update_count && position_count > 0; u++) {
+        Edge e = graph.edges[random() % graph.edges.size()];
+        Index pos = random() % position_count;
+        Node node = random() % node_count;
+        CompressedHyperGraph copy = compressed;
+        insert_edge_m.ms.push_back(time_ms([&]() { modify_insert_edge(copy, e); }));
+        insert_edge_m.items++;
+        copy = compressed;
+        Index found = -1;
+        double delete_ms = time_ms([&]() {
+            found = modify_find_edge(copy, e);
+            if (found != (Index) -1) // Like log_apply, an edge that is not found is not deleted.
+                try { modify_delete_edge(copy, found); } catch (int) {}
+        });
+        if (found != (Index) -1) {
+            delete_edge_m.ms.push_back(delete_ms);
+            delete_edge_m.items++;
+        }
+        copy = compressed;
+        insert_node_m.ms.push_back(time_ms([&]() { modify_insert_node_to_edge(copy, pos, node); }));
+        insert_node_m.items++;
+        copy = compressed;
+        Node own_node = prepared.rank_d(pos + 1) - 1; // A node of the edge at pos.
+        delete_node_m.ms.push_back(time_ms([&]() {
+            try { modify_delete_node_from_edge(copy, pos, own_node); } catch (int) {}
+        }));
+        delete_node_m.items++;
+    }
+    for (Measurement *m : {&insert_edge_m, &delete_edge_m, &insert_node_m, &delete_node_m})
+        if (!m->ms.empty())
+            results.push_back(*m);
+
+    printf("Graph: %lu edges, %lu nodes, %lu incidences\n", graph.edge_count, node_count, incidences);
+    printf("Size : %lu bytes (D %lu, PSI %lu, E %lu, ids %lu), %.3f bytes per incidence\n\n", bytes,
+           sdsl::size_in_bytes(compressed.D), sdsl::size_in_bytes(compressed.PSI), sdsl::size_in_bytes(compressed.E),
+           sdsl::size_in_bytes(compressed.ids), (double) bytes / max<uint64_t>(incidences, 1));
+    print_header();
+    for (const Measurement &m : results)
+        print_measurement(m);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file generate.cpp
+ * @author EA
+ *
+ * Writes a synthetic hypergraph in the input format of hypercsa-cli, see util/generator.hpp.
+ */
+
+#include <cstdio>
+#include <string>
+#include <getopt.h>
+
+#include "generator.hpp"
+
+using namespace std;
+
+static void print_usage() {
+    static const char* usage_str = \
+    "Usage: hypercsa-generate -o [output]\n"
+    "-h                                      show this help\n"
+    "-n [nodes]                              number of nodes, default 1000\n"
+    "-m [edges]                              number of edges, default 10000\n"
+    "-k [min size],[max size]                range of the edge sizes, default 1,8\n"
+    "-z [exponent]                           edge sizes follow a power law with this exponent instead of being uniform\n"
+    "-a [exponent]                           node degrees follow a power law with this exponent, default 0 (uniform)\n"
+    "-p [rate]                               rate of duplicated edges in [0, 1], default 0\n"
+    "-s [seed]                               seed, default 1. The output does not depend on the threads.\n"
+    "-j [threads]                            threads, default all cores\n"
+    "Nodes without edges are removed and the others renumbered, so the output may have fewer nodes.\n"
+    ;
+    fprintf(stderr, "%s", usage_str);
+}
+
+int main(int argc, char** argv) {
+    GeneratorConfig config;
+    string output_file;
+    int opt;
+    while ((opt = getopt(argc, argv, "ho:n:m:k:z:a:p:s:j:")) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'n':
+                config.nodes = stoull(optarg);
+                break;
+            case 'm':
+                config.edges = stoull(optarg);
+                break;
+            case 'k':
+                if (sscanf(optarg, "%lu,%lu", &config.min_size, &config.max_size) != 2) {
+                    fprintf(stderr, "Invalid edge sizes.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'z':
+                config.size_distribution = SIZE_POWER_LAW;
+                config.size_exponent = stod(optarg);
+                break;
+            case 'a':
+                config.degree_exponent = stod(optarg);
+                break;
+            case 'p':
+                config.duplicate_rate = stod(optarg);
+                break;
+            case 's':
+                config.seed = stoull(optarg);
+                break;
+            case 'j':
+                config.threads = stoi(optarg);
+                break;
+            case 'h':
+            default:
+                print_usage();
+                return 0;
+        }
+    }
+    if (output_file.empty()) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    if (generate_hypergraph_file(config, output_file.c_str()) != 0) {
+        fprintf(stderr, "Could not generate the hypergraph, check the parameters and the output file.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -2,6 +2,7 @@
 // Created by Enno Adler on 01.04.25.
 //
 
+#include <chrono>
 #include <iostream>
 #ifdef USE_PARALLEL_EXECUTION
 #include <execution>
@@ -103,7 +104,22 @@ int calc_d(int_vector<64> *linear, bit_vector *d)
     return 0;
 }
 
+// Adds the time since the last phase ended to phases.
+void construct_phase(PhaseTimes *phases, const char *name, chrono::steady_clock::time_point &last)
+{
+    if (phases == nullptr)
+        return;
+    auto now = chrono::steady_clock::now();
+    phases->emplace_back(name, chrono::duration<double, milli>(now - last).count());
+    last = now;
+}
+
 CompressedHyperGraph construct(HyperGraph& graph) {
+    return construct(graph, nullptr);
+}
+
+CompressedHyperGraph construct(HyperGraph& graph, PhaseTimes *phases) {
+    auto phase_start = chrono::steady_clock::now();
 #ifdef TRACK_MEMORY
     memory_monitor::start();
     memory_monitor::event("construct linear representation");
@@ -111,6 +127,7 @@ CompressedHyperGraph construct(HyperGraph& graph) {
 
     LinearRepresentation linear_representation(size_of_hypergraph(graph), 0, 64);
     compute_linear_representation(graph, &linear_representation);
+    construct_phase(phases, "linear representation", phase_start);
 #ifdef VERBOSE_DEBUG
         print_linear_representation(&linear_representation);
 #endif
@@ -119,6 +136,7 @@ CompressedHyperGraph construct(HyperGraph& graph) {
 #ifdef SDSL_PSI
     csa_sada<enc_vector<>, 32, 32, sa_order_sa_sampling<>, isa_sampling<>, int_alphabet<>> csa; // TODO: Use http://vios.dc.fi.udc.es/indexing/wsi/
     construct_im(csa, linear_representation, 8); // Note that csa.size = linear_representation.size + 1 (auto adds the 0 at the end)
+    construct_phase(phases, "suffix array", phase_start);
 #ifdef VERBOSE
         cout << "Size of CSA: " << size_in_bytes(csa) << " bytes, " << size_in_mega_bytes(csa) << "MB." << endl;
 #endif
@@ -135,6 +153,7 @@ CompressedHyperGraph construct(HyperGraph& graph) {
 #else
     copy(csa.psi.begin(), csa.psi.end(), psi_copy.begin());
 #endif
+    construct_phase(phases, "copy psi", phase_start);
 #ifdef VERBOSE
         print_psi_vector(&psi_copy);
         print_psi_vector_cycles(&psi_copy);
@@ -157,21 +176,26 @@ CompressedHyperGraph construct(HyperGraph& graph) {
       memory_monitor::event("adjust_psi");
 #endif
     adjust_psi(&psi_copy);
+    construct_phase(phases, "adjust psi", phase_start);
+    bit_vector e = edge_starts(psi_copy);
+    construct_phase(phases, "edge starts", phase_start);
 #ifdef TRACK_MEMORY
       memory_monitor::event("encode psi");
 #endif
     enc_vector<> comp_psi(psi_copy);
+    construct_phase(phases, "encode psi", phase_start);
 #ifdef TRACK_MEMORY
       memory_monitor::event("compute d");
 #endif
     // Create D.
     bit_vector d(linear_representation.size()+1, 0); // +1 for an additional 1 at the end to enable interval search via select commands.
     calc_d(&linear_representation, &d);
+    construct_phase(phases, "compute d", phase_start);
 
 #ifdef TRACK_MEMORY
     memory_monitor::event("finished");
     memory_monitor::stop();
     memory_monitor::write_memory_log<JSON_FORMAT>(cout);
 #endif
-    return {d, comp_psi};
+    return {d, comp_psi, e};
 }
\ No newline at end of file
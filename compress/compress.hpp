@@ -7,7 +7,14 @@
 
 #include "type_definitions.hpp"
 
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, double>> PhaseTimes; // Milliseconds of each phase of the construction.
+
 CompressedHyperGraph construct(HyperGraph& graph);
+CompressedHyperGraph construct(HyperGraph& graph, PhaseTimes *phases); // phases can be nullptr.
 
 
 #endif //HYPERCSA_COMPRESS_HPP
@@ -3,7 +3,9 @@
 //
 
 #include <iostream>
+#include <random>
 #include "type_definitions.hpp"
+#include "parse.hpp"
 
 using namespace std;
 
@@ -45,7 +47,7 @@ int parse_graph(const char *input_file, HyperGraph& graph, bool base_zero)
         edges.push_back(iv);
     }
 
-    cout << "Lowest node: " << lowest_node << endl;
+    cerr << "Lowest node: " << lowest_node << endl;
     if (lowest_node != 0 && base_zero) // If not 0-based, transform it 0-based.
     {
         for (auto & edge : edges)
@@ -88,14 +90,56 @@ int parse_graph(const char *input_file, HyperGraph& graph, bool base_zero)
     return 0;
 }
 
+int parse_boolean_query(const std::string& line, Edge& required, Edge& excluded)
+{
+    std::vector<uint64_t> nodes[2]; // Required and excluded.
+    std::string text = line;
+    for (char& ch : text) {
+        if (ch == ',' || ch == '\t') {
+            ch = ' ';
+        }
+    }
+    std::stringstream ss(text);
+    std::string token;
+    while (ss >> token) {
+        bool exclude = token[0] == '!';
+        size_t parsed = 0;
+        try {
+            nodes[exclude].push_back(std::stoull(token.substr(exclude), &parsed));
+        }
+        catch (...) {
+            return -1;
+        }
+        if (parsed != token.size() - exclude || !isdigit(token[exclude]))
+            return -1;
+    }
+    required = Edge(nodes[0].size());
+    std::copy(nodes[0].begin(), nodes[0].end(), required.begin());
+    excluded = Edge(nodes[1].size());
+    std::copy(nodes[1].begin(), nodes[1].end(), excluded.begin());
+    return 0;
+}
+
 int write_hyper_csa(const char *output_file, CompressedHyperGraph& g)
 {
     std::ofstream out(output_file);
     g.D.serialize(out);
     g.PSI.serialize(out);
+    uint64_t magic = EDGE_STARTS_MAGIC;
+    out.write((const char *) &magic, sizeof(magic));
+    g.E.serialize(out);
+    magic = EDGE_IDS_MAGIC;
+    out.write((const char *) &magic, sizeof(magic));
+    out.write((const char *) &g.next_id, sizeof(g.next_id));
+    g.ids.serialize(out);
+    random_device random;
+    uint64_t trailer[2] = {CHECKPOINT_MAGIC, 0};
+    while (trailer[1] == 0) // 0 is the id of files without trailer.
+        trailer[1] = ((uint64_t) random() << 32) ^ random();
+    out.write((const char *) trailer, sizeof(trailer));
     out.flush();
     out.close();
-    return 0;
+    return out ? 0 : -1;
 }
 
 CompressedHyperGraph load_hyper_csa(const char *input_file) {
@@ -104,6 +148,20 @@ CompressedHyperGraph load_hyper_csa(const char *input_file) {
     sdsl::bit_vector d;
     d.load(in);
     psi.load(in);
-    in.close();
-    return {d, psi}; // CompressedHyperGraph.
+    uint64_t magic = 0;
+    if (in.read((char *) &magic, sizeof(magic)) && magic == EDGE_STARTS_MAGIC)
+    {
+        sdsl::bit_vector e;
+        e.load(in);
+        uint64_t next_id = 0;
+        if (in.read((char *) &magic, sizeof(magic)) && magic == EDGE_IDS_MAGIC
+            && in.read((char *) &next_id, sizeof(next_id)))
+        {
+            sdsl::int_vector<> ids;
+            ids.load(in);
+            return {d, psi, e, ids, next_id};
+        }
+        return {d, psi, e}; // The ids are the ranks in E.
+    }
+    return {d, psi}; // CompressedHyperGraph, E is derived from PSI.
 }
@@ -8,6 +8,14 @@
 #include "type_definitions.hpp"
 
 int parse_graph(const char *input_file, HyperGraph& graph, bool base_zero);
+// A query of nodes separated by commas, spaces or tabs, where nodes with a leading '!' are excluded from the results,
+// e.g. "1,2,!7" for the edges with 1 and 2 but without 7. Returns -1 if a token is no number.
+int parse_boolean_query(const std::string& line, Edge& required, Edge& excluded);
+#define EDGE_STARTS_MAGIC 0x4843534145444745ULL // "HCSAEDGE", precedes E behind PSI. Older files end after PSI.
+#define EDGE_IDS_MAGIC 0x4843534149444e54ULL // "HCSAIDNT", precedes next_id and the stable ids behind E.
+#define CHECKPOINT_MAGIC 0x48435341434b5054ULL // "HCSACKPT", precedes the base id at the end, see update_log.hpp.
+
+// Every written file gets a new random base id, so an update log of an older file with the same name is ignored.
 int write_hyper_csa(const char *output_file, CompressedHyperGraph& g);
 CompressedHyperGraph load_hyper_csa(const char *input_file);
 
@@ -0,0 +1,261 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "update_log.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "parse.hpp"
+#include "modify.hpp"
+
+using namespace std;
+
+string log_path(const char *hcsa_file)
+{
+    return string(hcsa_file) + ".log";
+}
+
+uint64_t log_checksum(const vector<uint64_t> &words)
+{
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a over the words.
+    for (uint64_t word : words)
+        hash = (hash ^ word) * 1099511628211ULL;
+    return hash;
+}
+
+int log_write_all(int fd, const vector<uint64_t> &words)
+{
+    const char *data = (const char *) words.data();
+    size_t remaining = words.size() * sizeof(uint64_t);
+    while (remaining > 0)
+    {
+        ssize_t written = write(fd, data, remaining);
+        if (written < 0)
+            return -1;
+        data += written;
+        remaining -= written;
+    }
+    return 0;
+}
+
+// Id of the base, stored at the end by write_hyper_csa. Files written without it have id 0.
+uint64_t log_base_id(const char *hcsa_file)
+{
+    ifstream in(hcsa_file, ios::binary | ios::ate);
+    uint64_t trailer[2] = {0, 0};
+    if (!in || (uint64_t) in.tellg() < sizeof(trailer))
+        return 0;
+    in.seekg(-(streamoff) sizeof(trailer), ios::end);
+    in.read((char *) trailer, sizeof(trailer));
+    return (in && trailer[0] == CHECKPOINT_MAGIC) ? trailer[1] : 0;
+}
+
+/*
+ * Reads the valid records of the log into records.
+ * Returns the length in bytes of the valid part, 0 if the log is missing or belongs to an older base.
+ */
+uint64_t log_read_valid(const char *hcsa_file, vector<LogRecord> &records)
+{
+    ifstream in(log_path(hcsa_file), ios::binary);
+    uint64_t header[2];
+    if (!in.read((char *) header, sizeof(header)) || header[0] != LOG_MAGIC || header[1] != log_base_id(hcsa_file))
+        return 0;
+    uint64_t valid = sizeof(header);
+
+    while (true)
+    {
+        vector<uint64_t> words(3);
+        if (!in.read((char *) words.data(), 3 * sizeof(uint64_t)))
+            break;
+        uint64_t k = words[2];
+        if (k > (1ULL << 32))
+            break; // Torn or corrupt length.
+        words.resize(3 + k);
+        uint64_t checksum;
+        if (!in.read((char *) (words.data() + 3), k * sizeof(uint64_t)) || !in.read((char *) &checksum, sizeof(checksum)))
+            break;
+        if (checksum != log_checksum(words))
+            break;
+        records.push_back({words[0], words[1], vector<Node>(words.begin() + 3, words.end())});
+        valid += (4 + k) * sizeof(uint64_t);
+    }
+    return valid;
+}
+
+int log_read(const char *hcsa_file, vector<LogRecord> &records)
+{
+    log_read_valid(hcsa_file, records);
+    return 0;
+}
+
+// Starts an empty log for the base with the given id.
+int log_reset(int fd, uint64_t base_id)
+{
+    if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+        return -1;
+    if (log_write_all(fd, {LOG_MAGIC, base_id}) != 0)
+        return -1;
+    return fsync(fd);
+}
+
+int log_open(UpdateLog &log, const char *hcsa_file)
+{
+    log.path = log_path(hcsa_file);
+    vector<LogRecord> records;
+    uint64_t valid = log_read_valid(hcsa_file, records);
+    log.fd = open(log.path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (log.fd < 0)
+        return -1;
+    int result;
+    if (valid == 0) // Missing, stale or without header.
+        result = log_reset(log.fd, log_base_id(hcsa_file));
+    else // Drop a torn record at the end, so the next records are appended behind the valid ones.
+        result = (ftruncate(log.fd, valid) == 0 && lseek(log.fd, 0, SEEK_END) >= 0) ? 0 : -1;
+    if (result != 0)
+        log_close(log);
+    return result;
+}
+
+void log_close(UpdateLog &log)
+{
+    if (log.fd >= 0)
+        close(log.fd);
+    log.fd = -1;
+}
+
+int log_append(UpdateLog &log, const LogRecord &record)
+{
+    if (log.fd < 0)
+        return -1;
+    vector<uint64_t> words = {record.op, record.node, record.nodes.size()};
+    words.insert(words.end(), record.nodes.begin(), record.nodes.end());
+    words.push_back(log_checksum(words));
+    if (log_write_all(log.fd, words) != 0)
+        return -1;
+    return fsync(log.fd);
+}
+
+int log_apply(CompressedHyperGraph &g, const LogRecord &record)
+{
+    Edge edge(record.nodes.size());
+    for (Index i = 0; i < record.nodes.size(); i++)
+        edge[i] = record.nodes[i];
+    try {
+        if (record.op == LOG_INSERT_EDGE)
+            return modify_insert_edge(g, edge);
+        Index pos = modify_find_edge(g, edge);
+        if (pos == (Index) -1)
+            return -1; // There is no such edge.
+        switch (record.op) {
+            case LOG_DELETE_EDGE:
+                return modify_delete_edge(g, pos);
+            case LOG_INSERT_NODE:
+                return modify_insert_node_to_edge(g, pos, record.node);
+            case LOG_DELETE_NODE:
+                return modify_delete_node_from_edge(g, pos, record.node);
+            default:
+                return -1;
+        }
+    }
+    catch (int) { // A node would lose its last position.
+        return -1;
+    }
+}
+
+CompressedHyperGraph load_hyper_csa_with_log(const char *hcsa_file)
+{
+    CompressedHyperGraph g = load_hyper_csa(hcsa_file);
+    vector<LogRecord> records;
+    log_read(hcsa_file, records);
+    for (const LogRecord &record : records)
+        log_apply(g, record); // A record that fails, e.g. an insert with a node without interval, is skipped.
+    return g;
+}
+
+int log_sync_file(const string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return -1;
+    int result = fsync(fd);
+    close(fd);
+    return result;
+}
+
+// Makes a rename in the directory of the file durable.
+int log_sync_directory(const string &path)
+{
+    size_t slash = path.rfind('/');
+    if (slash == string::npos)
+        return log_sync_file(".");
+    return log_sync_file(slash == 0 ? "/" : path.substr(0, slash));
+}
+
+/*
+ * Folds the log into a new base: the new base is written next to the old one and renamed over it.
+ * From then on the log belongs to an older base and is ignored, until it is reset for the new base.
+ */
+int log_checkpoint(const char *hcsa_file)
+{
+    CompressedHyperGraph g = load_hyper_csa_with_log(hcsa_file);
+
+    string temporary = string(hcsa_file) + ".tmp";
+    if (write_hyper_csa(temporary.c_str(), g) != 0 || log_sync_file(temporary) != 0
+        || rename(temporary.c_str(), hcsa_file) != 0)
+    {
+        unlink(temporary.c_str());
+        return -1;
+    }
+    // The log is only reset once the new base is durable, otherwise a crash could lose the logged updates.
+    uint64_t base_id = log_base_id(hcsa_file);
+    if (log_sync_directory(hcsa_file) != 0)
+        return -1;
+
+    int fd = open(log_path(hcsa_file).c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return -1;
+    int result = log_reset(fd, base_id);
+    close(fd);
+    return result;
+}
+
+LogRecord log_record(uint64_t op, Edge &edge, Node node)
+{
+    return {op, node, vector<Node>(edge.begin(), edge.end())};
+}
+
+int log_insert_edge(UpdateLog &log, CompressedHyperGraph &g, Edge edge)
+{
+    LogRecord record = log_record(LOG_INSERT_EDGE, edge, 0);
+    if (log_apply(g, record) != 0)
+        return -1;
+    return log_append(log, record);
+}
+
+int log_delete_edge(UpdateLog &log, CompressedHyperGraph &g, Edge edge)
+{
+    LogRecord record = log_record(LOG_DELETE_EDGE, edge, 0);
+    if (log_apply(g, record) != 0)
+        return -1;
+    return log_append(log, record);
+}
+
+int log_insert_node_to_edge(UpdateLog &log, CompressedHyperGraph &g, Edge edge, Node node)
+{
+    LogRecord record = log_record(LOG_INSERT_NODE, edge, node);
+    if (log_apply(g, record) != 0)
+        return -1;
+    return log_append(log, record);
+}
+
+int log_delete_node_from_edge(UpdateLog &log, CompressedHyperGraph &g, Edge edge, Node node)
+{
+    LogRecord record = log_record(LOG_DELETE_NODE, edge, node);
+    if (log_apply(g, record) != 0)
+        return -1;
+    return log_append(log, record);
+}
@@ -0,0 +1,58 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_UPDATE_LOG_HPP
+#define HYPERCSA_UPDATE_LOG_HPP
+
+#include <string>
+#include <vector>
+
+#include "type_definitions.hpp"
+
+#define LOG_INSERT_EDGE 0
+#define LOG_DELETE_EDGE 1
+#define LOG_INSERT_NODE 2
+#define LOG_DELETE_NODE 3
+
+#define LOG_MAGIC 0x48435341554c4f47ULL // "HCSAULOG"
+
+/*
+ * Append-only log of the updates next to a .hcsa file, named like it with the suffix .log.
+ * The log starts with the id of the base it belongs to, which write_hyper_csa stores at the end of the file. Each
+ * written file gets a new id, so a log that was already folded by a checkpoint is recognized, even if the checkpoint
+ * was interrupted, and so is a log left next to a file that was compressed again.
+ * Each record is [op, node, k, k nodes, checksum] in 64 bit words. A torn record at the end is dropped, and a record
+ * that fails when it is replayed is skipped.
+ */
+class LogRecord {
+public:
+    uint64_t op;
+    Node node; // Only used by the node updates.
+    std::vector<Node> nodes;
+};
+
+class UpdateLog {
+public:
+    int fd;
+    std::string path;
+
+    UpdateLog() : fd(-1) {}
+};
+
+std::string log_path(const char *hcsa_file);
+int log_open(UpdateLog& log, const char *hcsa_file);
+void log_close(UpdateLog& log);
+int log_append(UpdateLog& log, const LogRecord& record);
+int log_read(const char *hcsa_file, std::vector<LogRecord>& records);
+int log_apply(CompressedHyperGraph& g, const LogRecord& record);
+CompressedHyperGraph load_hyper_csa_with_log(const char *hcsa_file);
+int log_checkpoint(const char *hcsa_file);
+
+// The update is applied first and only logged if it succeeded. It is durable when 0 is returned.
+int log_insert_edge(UpdateLog& log, CompressedHyperGraph& g, Edge edge);
+int log_delete_edge(UpdateLog& log, CompressedHyperGraph& g, Edge edge);
+int log_insert_node_to_edge(UpdateLog& log, CompressedHyperGraph& g, Edge edge, Node node);
+int log_delete_node_from_edge(UpdateLog& log, CompressedHyperGraph& g, Edge edge, Node node);
+
+#endif //HYPERCSA_UPDATE_LOG_HPP
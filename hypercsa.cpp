@@ -9,26 +9,45 @@
 #include "parse.hpp"
 #include "read.hpp"
 #include "modify.hpp"
+#include "dynamic.hpp"
+#include "delta.hpp"
+#include "snapshot.hpp"
+#include "update_log.hpp"
+#include "server.hpp"
+#include "report.hpp"
+#include "histogram.hpp"
+#include "generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <random>
+#include <thread>
+#include <unistd.h>
 
 #include "test.h"
-#ifdef VERBOSE_DEBUG
 #include "prints.hpp"
-#endif
 
 using namespace std;
 
 ///////////// Library related operations /////////////////////
+namespace hypercsa {
+
 CompressedHyperGraph construct(const char *input_file)
 {
     HyperGraph graph;
     parse_graph(input_file, graph, true);
-    CompressedHyperGraph compressed_graph = construct(graph);
+    CompressedHyperGraph compressed_graph = ::construct(graph);
     return compressed_graph;
 }
 
 CompressedHyperGraph from_file(const char *input_file)
 {
-    CompressedHyperGraph compressed_graph = load_hyper_csa(input_file);
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
     return compressed_graph;
 }
 
@@ -47,22 +66,426 @@ int delete_edge(CompressedHyperGraph &hgraph, Index pos)
     return modify_delete_edge(hgraph, pos);
 }
 
-//EdgeIterator querys(CompressedHyperGraph graph, int type, Edge edge)
-//{
-//    return query_iterator(graph, query, type);
-//}
-//
-//Index edge_iterator_next(EdgeIterator ei)
-//{
-//    return next(ei);
-//}
-//
-//void edge_iterator_finish(EdgeIterator ei)
-//{
-//
-//}
+int delete_node_from_edge(CompressedHyperGraph &hgraph, Index pos, Node node)
+{
+    return modify_delete_node_from_edge(hgraph, pos, node);
+}
+
+int insert_edge(CompressedHyperGraph &hgraph, Edge edge)
+{
+    return modify_insert_edge(hgraph, std::move(edge));
+}
+
+int insert_node_to_edge(CompressedHyperGraph &hgraph, Index pos, Node node)
+{
+    return modify_insert_node_to_edge(hgraph, pos, node);
+}
+
+Index edge_position(CompressedHyperGraph &hgraph, Index id)
+{
+    return modify_find_id(hgraph, id);
+}
+
+EdgeList query(CompressedHyperGraph &hgraph, Edge query, int type)
+{
+    PreparedHyperGraph prepared(hgraph);
+    return ::query(prepared, std::move(query), type);
+}
+
+}
+
+///////////// Handle based operations /////////////////////
+struct hypercsa_index {
+    CompressedHyperGraph graph;
+    PreparedHyperGraph prepared; // Built once, so the queries do not rebuild rank and select on D.
+
+    explicit hypercsa_index(CompressedHyperGraph g) : graph(std::move(g)), prepared(graph) {}
+};
+
+hypercsa_index *hypercsa_open(const char *input_file)
+{
+    ifstream in(input_file);
+    if (!in.good())
+        return nullptr;
+    in.close();
+    try {
+        return new hypercsa_index(load_hyper_csa_with_log(input_file));
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void hypercsa_close(hypercsa_index *index)
+{
+    delete index;
+}
+
+Edge edge_from_array(const uint64_t *nodes, size_t length)
+{
+    Edge edge(length);
+    for (size_t i = 0; i < length; i++)
+        edge[i] = nodes[i];
+    return edge;
+}
+
+bool valid_query(hypercsa_index *index, int type, const uint64_t *nodes, size_t length)
+{
+    return index != nullptr && type >= EXACT && type <= RANGE && (nodes != nullptr || length == 0);
+}
+
+int64_t hypercsa_count(hypercsa_index *index, int type, const uint64_t *nodes, size_t length)
+{
+    if (!valid_query(index, type, nodes, length))
+        return -1;
+    return (int64_t) query_count(index->prepared, edge_from_array(nodes, length), type);
+}
+
+// Writes each edge as its size followed by its nodes, only the edges that fit completely. Returns the number of words.
+int64_t write_edges(const FlatEdgeList<uint64_t>& result, uint64_t *buffer, size_t capacity)
+{
+    size_t words = 0;
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        size_t edge_size = result.offsets[i + 1] - result.offsets[i];
+        if (words + 1 + edge_size <= capacity) // Only complete edges are written.
+        {
+            buffer[words] = edge_size;
+            copy(result.nodes.begin() + result.offsets[i], result.nodes.begin() + result.offsets[i + 1], buffer + words + 1);
+        }
+        words += 1 + edge_size;
+    }
+    return (int64_t) words;
+}
+
+int64_t hypercsa_query(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                       uint64_t *buffer, size_t capacity)
+{
+    if (!valid_query(index, type, nodes, length) || (buffer == nullptr && capacity > 0))
+        return -1;
+    static thread_local FlatEdgeList<uint64_t> result; // Reused, so repeated queries only allocate their nodes.
+    result.clear();
+    query(index->prepared, edge_from_array(nodes, length), type, result);
+    return write_edges(result, buffer, capacity);
+}
+
+template<class T>
+int query_csr(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+              uint64_t *offsets, size_t offsets_capacity, T *node_ids, size_t node_ids_capacity,
+              size_t *edges, size_t *total_nodes, QueryStats& stats)
+{
+    if (!valid_query(index, type, nodes, length) || edges == nullptr || total_nodes == nullptr)
+        return -1;
+    if (index->prepared.nodes > 0 && index->prepared.nodes - 1 > numeric_limits<T>::max())
+        return -1; // The node ids do not fit.
+    static thread_local FlatEdgeList<T> result;
+    result.clear();
+    query(index->prepared, edge_from_array(nodes, length), type, result, stats);
+    *edges = result.size();
+    *total_nodes = result.nodes.size();
+    if (result.offsets.size() > offsets_capacity || result.nodes.size() > node_ids_capacity)
+        return 1;
+    copy(result.offsets.begin(), result.offsets.end(), offsets);
+    copy(result.nodes.begin(), result.nodes.end(), node_ids);
+    return 0;
+}
+
+int hypercsa_query_csr(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                       uint64_t *offsets, size_t offsets_capacity, uint64_t *node_ids, size_t node_ids_capacity,
+                       size_t *edges, size_t *total_nodes)
+{
+    QueryStats stats;
+    return query_csr(index, type, nodes, length, offsets, offsets_capacity, node_ids, node_ids_capacity, edges, total_nodes, stats);
+}
 
-Node next(EdgeIterator);
+int hypercsa_query_csr32(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                         uint64_t *offsets, size_t offsets_capacity, uint32_t *node_ids, size_t node_ids_capacity,
+                         size_t *edges, size_t *total_nodes)
+{
+    QueryStats stats;
+    return query_csr(index, type, nodes, length, offsets, offsets_capacity, node_ids, node_ids_capacity, edges, total_nodes, stats);
+}
+
+int64_t hypercsa_count_sized(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                             uint64_t min_size, uint64_t max_size)
+{
+    if (!valid_query(index, type, nodes, length))
+        return -1;
+    return (int64_t) query_count(index->prepared, edge_from_array(nodes, length), type, min_size, max_size);
+}
+
+int64_t hypercsa_query_sized(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                             uint64_t min_size, uint64_t max_size, uint64_t *buffer, size_t capacity)
+{
+    if (!valid_query(index, type, nodes, length) || (buffer == nullptr && capacity > 0))
+        return -1;
+    static thread_local FlatEdgeList<uint64_t> result;
+    result.clear();
+    QueryStats stats;
+    query(index->prepared, edge_from_array(nodes, length), type, min_size, max_size, result, stats);
+    return write_edges(result, buffer, capacity);
+}
+
+int64_t hypercsa_count_overlap(hypercsa_index *index, const uint64_t *nodes, size_t length, uint64_t threshold)
+{
+    if (!valid_query(index, OVERLAP, nodes, length))
+        return -1;
+    return (int64_t) query_overlap_count(index->prepared, edge_from_array(nodes, length), threshold);
+}
+
+int64_t hypercsa_query_overlap(hypercsa_index *index, const uint64_t *nodes, size_t length, uint64_t threshold,
+                               uint64_t *buffer, size_t capacity)
+{
+    if (!valid_query(index, OVERLAP, nodes, length) || (buffer == nullptr && capacity > 0))
+        return -1;
+    static thread_local FlatEdgeList<uint64_t> result;
+    result.clear();
+    QueryStats stats;
+    query_overlap(index->prepared, edge_from_array(nodes, length), threshold, result, stats);
+    return write_edges(result, buffer, capacity);
+}
+
+int64_t hypercsa_count_boolean(hypercsa_index *index, const uint64_t *nodes, size_t length,
+                               const uint64_t *excluded, size_t excluded_length)
+{
+    if (!valid_query(index, CONTAIN, nodes, length) || (excluded == nullptr && excluded_length > 0))
+        return -1;
+    return (int64_t) query_boolean_count(index->prepared, edge_from_array(nodes, length),
+                                         edge_from_array(excluded, excluded_length));
+}
+
+int64_t hypercsa_query_boolean(hypercsa_index *index, const uint64_t *nodes, size_t length,
+                               const uint64_t *excluded, size_t excluded_length, uint64_t *buffer, size_t capacity)
+{
+    if (!valid_query(index, CONTAIN, nodes, length) || (excluded == nullptr && excluded_length > 0)
+        || (buffer == nullptr && capacity > 0))
+        return -1;
+    static thread_local FlatEdgeList<uint64_t> result;
+    result.clear();
+    QueryStats stats;
+    query_boolean(index->prepared, edge_from_array(nodes, length), edge_from_array(excluded, excluded_length), result, stats);
+    return write_edges(result, buffer, capacity);
+}
+
+int64_t hypercsa_top_jaccard(hypercsa_index *index, const uint64_t *nodes, size_t length, size_t k,
+                             unsigned threads, uint64_t *edge_ids, double *similarities)
+{
+    if (index == nullptr || (nodes == nullptr && length > 0) || (k > 0 && (edge_ids == nullptr || similarities == nullptr)))
+        return -1;
+    vector<SimilarEdge> best = query_jaccard(index->prepared, edge_from_array(nodes, length), k, threads);
+    for (size_t i = 0; i < best.size(); i++)
+    {
+        edge_ids[i] = best[i].id;
+        similarities[i] = best[i].similarity;
+    }
+    return (int64_t) best.size();
+}
+
+int64_t hypercsa_neighbors(hypercsa_index *index, uint64_t node, size_t k, unsigned threads, uint64_t *nodes,
+                           uint64_t *counts, size_t capacity)
+{
+    if (index == nullptr || ((nodes == nullptr || counts == nullptr) && capacity > 0))
+        return -1;
+    vector<Neighbor> neighbors = query_neighbors(index->prepared, node, k, threads);
+    if (neighbors.size() <= capacity)
+    {
+        for (size_t i = 0; i < neighbors.size(); i++)
+        {
+            nodes[i] = neighbors[i].node;
+            counts[i] = neighbors[i].count;
+        }
+    }
+    return (int64_t) neighbors.size();
+}
+
+int64_t hypercsa_degree(hypercsa_index *index, uint64_t node)
+{
+    if (index == nullptr)
+        return -1;
+    return (int64_t) node_degree(index->prepared, node);
+}
+
+int hypercsa_degrees(hypercsa_index *index, const uint64_t *nodes, size_t length, uint64_t *degrees)
+{
+    if (index == nullptr || ((nodes == nullptr || degrees == nullptr) && length > 0))
+        return -1;
+    for (size_t i = 0; i < length; i++)
+        degrees[i] = node_degree(index->prepared, nodes[i]);
+    return 0;
+}
+
+int64_t hypercsa_top_degrees(hypercsa_index *index, size_t k, unsigned threads, uint64_t *nodes, uint64_t *degrees)
+{
+    if (index == nullptr || ((nodes == nullptr || degrees == nullptr) && k > 0))
+        return -1;
+    vector<NodeDegree> top = top_degrees(index->prepared, k, threads);
+    for (size_t i = 0; i < top.size(); i++)
+    {
+        nodes[i] = top[i].node;
+        degrees[i] = top[i].degree;
+    }
+    return (int64_t) top.size();
+}
+
+int64_t hypercsa_cardinality_histogram(hypercsa_index *index, uint64_t *counts, size_t capacity)
+{
+    if (index == nullptr || (counts == nullptr && capacity > 0))
+        return -1;
+    const vector<uint64_t>& histogram = cardinality_histogram(index->prepared);
+    if (histogram.size() <= capacity)
+        copy(histogram.begin(), histogram.end(), counts);
+    return (int64_t) histogram.size();
+}
+
+int hypercsa_count_batch(hypercsa_index *index, int type, const uint64_t *nodes, const size_t *offsets,
+                         size_t queries, int64_t *counts)
+{
+    if (index == nullptr || offsets == nullptr || counts == nullptr || (nodes == nullptr && offsets[queries] > 0))
+        return -1;
+    for (size_t i = 0; i < queries; i++)
+        counts[i] = hypercsa_count(index, type, nodes + offsets[i], offsets[i + 1] - offsets[i]);
+    return 0;
+}
+
+int64_t hypercsa_query_batch(hypercsa_index *index, int type, const uint64_t *nodes, const size_t *offsets,
+                             size_t queries, int64_t *counts, uint64_t *buffer, size_t capacity)
+{
+    if (index == nullptr || offsets == nullptr || counts == nullptr || (nodes == nullptr && offsets[queries] > 0)
+        || (buffer == nullptr && capacity > 0))
+        return -1;
+    static thread_local FlatEdgeList<uint64_t> result; // All queries append to it, see hypercsa_query.
+    result.clear();
+    for (size_t i = 0; i < queries; i++)
+    {
+        size_t length = offsets[i + 1] - offsets[i];
+        if (!valid_query(index, type, nodes + offsets[i], length))
+            counts[i] = -1;
+        else
+            counts[i] = (int64_t) query(index->prepared, edge_from_array(nodes + offsets[i], length), type, result);
+    }
+    return write_edges(result, buffer, capacity);
+}
+
+int hypercsa_stats_enabled(void)
+{
+    return QueryStats::enabled;
+}
+
+int64_t hypercsa_edge_count(hypercsa_index *index)
+{
+    if (index == nullptr)
+        return -1;
+    return (int64_t) index->prepared.edges;
+}
+
+int64_t hypercsa_edge(hypercsa_index *index, uint64_t edge_id, uint64_t *nodes, size_t capacity)
+{
+    if (index == nullptr || edge_id >= index->prepared.edges || (nodes == nullptr && capacity > 0))
+        return -1;
+    Edge edge = decompress_edge_by_id(index->prepared, edge_id);
+    if (edge.size() <= capacity)
+        copy(edge.begin(), edge.end(), nodes);
+    return (int64_t) edge.size();
+}
+
+int64_t hypercsa_stable_id(hypercsa_index *index, uint64_t edge_id)
+{
+    if (index == nullptr || edge_id >= index->prepared.edges)
+        return -1;
+    return (int64_t) index->graph.ids[edge_id];
+}
+
+int64_t hypercsa_edge_of_stable_id(hypercsa_index *index, uint64_t stable_id)
+{
+    if (index == nullptr)
+        return -1;
+    Index position = stable_position(index->prepared, stable_id);
+    if (position == (Index) -1)
+        return -1;
+    return (int64_t) index->graph.id_ranks[stable_id];
+}
+
+int hypercsa_build_hubs(hypercsa_index *index, size_t k)
+{
+    if (index == nullptr)
+        return -1;
+    prepared_build_hubs(index->prepared, k);
+    return 0;
+}
+
+int hypercsa_build_edge_samples(hypercsa_index *index, size_t rate)
+{
+    if (index == nullptr)
+        return -1;
+    prepared_build_samples(index->prepared, rate);
+    return 0;
+}
+
+int hypercsa_edges_equal(hypercsa_index *index, uint64_t position1, uint64_t position2)
+{
+    if (index == nullptr || position1 >= index->graph.PSI.size() || position2 >= index->graph.PSI.size())
+        return -1;
+    return read_edges_equal(index->prepared, position1, position2) ? 1 : 0;
+}
+
+int64_t hypercsa_space_report(hypercsa_index *index, char *buffer, size_t capacity)
+{
+    if (index == nullptr || (buffer == nullptr && capacity > 0))
+        return -1;
+    stringstream report;
+    if (write_space_report(index->prepared, report) != 0)
+        return -1;
+    string json = report.str();
+    if (json.size() < capacity)
+        copy(json.c_str(), json.c_str() + json.size() + 1, buffer);
+    return (int64_t) json.size();
+}
+
+void add_stats(hypercsa_stats *to, const QueryStats& stats)
+{
+    to->queries += stats.queries;
+    to->results += stats.results;
+    to->psi_accesses += stats.psi_accesses;
+    to->rank_calls += stats.rank_calls;
+    to->select_calls += stats.select_calls;
+    to->cycles_examined += stats.cycles_examined;
+    to->cycles_pruned += stats.cycles_pruned;
+    to->edges_decompressed += stats.edges_decompressed;
+    to->postings_read += stats.postings_read;
+    to->interval_ns += stats.interval_ns;
+    to->scan_ns += stats.scan_ns;
+}
+
+int hypercsa_query_csr_stats(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                             uint64_t *offsets, size_t offsets_capacity, uint64_t *node_ids, size_t node_ids_capacity,
+                             size_t *edges, size_t *total_nodes, hypercsa_stats *stats)
+{
+    if (stats == nullptr)
+        return -1;
+    QueryStats query_stats;
+    int result = query_csr(index, type, nodes, length, offsets, offsets_capacity, node_ids, node_ids_capacity, edges, total_nodes, query_stats);
+    add_stats(stats, query_stats);
+    return result;
+}
+
+int hypercsa_count_batch_stats(hypercsa_index *index, int type, const uint64_t *nodes, const size_t *offsets,
+                               size_t queries, int64_t *counts, hypercsa_stats *stats)
+{
+    if (index == nullptr || offsets == nullptr || counts == nullptr || stats == nullptr
+        || (nodes == nullptr && offsets[queries] > 0))
+        return -1;
+    QueryStats batch_stats;
+    for (size_t i = 0; i < queries; i++)
+    {
+        size_t length = offsets[i + 1] - offsets[i];
+        if (!valid_query(index, type, nodes + offsets[i], length))
+            counts[i] = -1;
+        else
+            counts[i] = (int64_t) query_count(index->prepared, edge_from_array(nodes + offsets[i], length), type, batch_stats);
+    }
+    add_stats(stats, batch_stats);
+    return 0;
+}
 
 ///////////// Test and CLI related operations ////////////////////////
 
@@ -113,24 +536,308 @@ int construct_hypercsa(const char *input_file, const char *output_file)
     return 0;
 }
 
-int query_hypercsa(const char *input_file, int type, const char *node_query)
+int query_hypercsa(const char *input_file, int type, const char *node_query, int threshold)
 {
-    CompressedHyperGraph compressed_graph = load_hyper_csa(input_file);
-    EdgeList el = query(compressed_graph, parse_edge_from_string(node_query), type);
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+    EdgeList el;
+    if (type == OVERLAP)
+    {
+        PreparedHyperGraph prepared(compressed_graph);
+        el = query_overlap(prepared, parse_edge_from_string(node_query), threshold);
+    }
+    else if (type == CONTAIN)
+    {
+        Edge required, excluded;
+        if (parse_boolean_query(node_query, required, excluded) < 0)
+        {
+            cerr << "Query is no list of nodes." << endl;
+            return -1;
+        }
+        PreparedHyperGraph prepared(compressed_graph);
+        el = query_boolean(prepared, required, excluded);
+    }
+    else
+        el = query(compressed_graph, parse_edge_from_string(node_query), type);
     cout << "Query has " << el.size() << " results." << endl;
     return 0;
 }
 
-void query_hypercsa_from_file(const char* input_file, int type, const char* test_file)
+void print_query_stats(const QueryStats& stats)
+{
+    cout << "  psi accesses " << stats.psi_accesses << ", rank " << stats.rank_calls << ", select " << stats.select_calls
+         << ", cycles examined " << stats.cycles_examined << ", pruned " << stats.cycles_pruned
+         << ", edges decompressed " << stats.edges_decompressed << ", postings read " << stats.postings_read
+         << ", interval " << stats.interval_ns / 1000.0 << " us, scan " << stats.scan_ns / 1000.0 << " us" << endl;
+}
+
+// The contains queries of the file, where excluded nodes are marked with '!', see parse_boolean_query.
+int parse_boolean_queries(const char *test_file, EdgeList& required, EdgeList& excluded)
+{
+    ifstream in(test_file);
+    string line;
+    for (int i = 0; getline(in, line); i++)
+    {
+        Edge r, e;
+        if (parse_boolean_query(line, r, e) < 0)
+        {
+            cerr << "Query " << i << " is no list of nodes." << endl;
+            return -1;
+        }
+        required.push_back(r);
+        excluded.push_back(e);
+    }
+    return 0;
+}
+
+void query_hypercsa_from_file(const char* input_file, int type, const char* test_file, int threshold)
 {
     HyperGraph graph;
-    parse_graph(test_file, graph, false);
-    CompressedHyperGraph compressed_graph = load_hyper_csa(input_file);
+    EdgeList excluded;
+    if (type == CONTAIN)
+    {
+        if (parse_boolean_queries(test_file, graph.edges, excluded) < 0)
+            return;
+        graph.edge_count = graph.edges.size();
+    }
+    else
+        parse_graph(test_file, graph, false);
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+    PreparedHyperGraph prepared(compressed_graph);
+    QueryStats total;
     for (int i=0; i < graph.edge_count; i++)
     {
-        EdgeList el = query(compressed_graph, graph.edges[i], type);
+        QueryStats stats;
+        EdgeList el = type == OVERLAP ? query_overlap(prepared, graph.edges[i], threshold, stats)
+                    : type == CONTAIN ? query_boolean(prepared, graph.edges[i], excluded[i], stats)
+                                      : query(prepared, graph.edges[i], type, stats);
         cout << "Query " << i << " has " << el.size() << " results." << endl;
+        if (QueryStats::enabled)
+            print_query_stats(stats);
+        total += stats;
+    }
+    if (QueryStats::enabled)
+    {
+        cout << "All " << total.queries << " queries with " << total.results << " results:" << endl;
+        print_query_stats(total);
+    }
+}
+
+void print_latency_text(const char *type_name, const LatencyHistogram& h, const string& size)
+{
+    printf("%-9s %6s %10lu %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f\n", type_name, size.c_str(), h.count(),
+           h.mean() / 1000.0, h.percentile(0.5) / 1000.0, h.percentile(0.9) / 1000.0, h.percentile(0.99) / 1000.0,
+           h.percentile(0.999) / 1000.0, h.max() / 1000.0);
+}
+
+void print_latency_json(const LatencyHistogram& h)
+{
+    printf("\"queries\": %lu, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p99.9\": %.3f, \"max\": %.3f",
+           h.count(), h.mean() / 1000.0, h.percentile(0.5) / 1000.0, h.percentile(0.9) / 1000.0,
+           h.percentile(0.99) / 1000.0, h.percentile(0.999) / 1000.0, h.max() / 1000.0);
+}
+
+int latency_hypercsa_from_file(const char* input_file, int type, const char* test_file, int json, int hubs)
+{
+    if (type < EXACT || type > RANGE)
+        return -1;
+    HyperGraph graph;
+    if (parse_graph(test_file, graph, false) != 0)
+        return -1;
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+    PreparedHyperGraph prepared(compressed_graph);
+    if (hubs > 0)
+        prepared_build_hubs(prepared, hubs);
+    map<uint64_t, LatencyHistogram> by_size;
+    LatencyHistogram all;
+    FlatEdgeList<uint64_t> result;
+    for (Edge& q : graph.edges)
+    {
+        result.clear();
+        auto start = chrono::steady_clock::now();
+        query(prepared, q, type, result);
+        uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        by_size[q.size()].record(ns);
+        all.record(ns);
+    }
+
+    const char *type_names[] = {"exact", "contains", "subset", "overlap", "prefix", "range"};
+    const char *type_name = type_names[type];
+    if (json)
+    {
+        printf("{\"unit\": \"us\", \"type\": \"%s\", ", type_name);
+        print_latency_json(all);
+        printf(", \"sizes\": [");
+        for (auto it = by_size.begin(); it != by_size.end(); it++)
+        {
+            printf("%s{\"size\": %lu, ", it == by_size.begin() ? "" : ", ", it->first);
+            print_latency_json(it->second);
+            printf("}");
+        }
+        printf("]}\n");
+    }
+    else
+    {
+        printf("%-9s %6s %10s %12s %12s %12s %12s %12s %12s\n", "Type", "Size", "Queries", "Mean us", "p50 us", "p90 us",
+               "p99 us", "p99.9 us", "Max us");
+        for (auto& entry : by_size)
+            print_latency_text(type_name, entry.second, to_string(entry.first));
+        print_latency_text(type_name, all, "all");
+    }
+    return 0;
+}
+
+// True if the graph has a copy of the edge. The exact query also returns some supersets, so whole edges are compared.
+bool update_edge_exists(PreparedHyperGraph &prepared, Edge edge)
+{
+    sort(edge.begin(), edge.end());
+    for (Edge &result : query(prepared, edge, EXACT))
+    {
+        sort(result.begin(), result.end());
+        if (result == edge)
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Appends the update to the log without applying it, the next load replays it. An insert is appended right away, a
+ * delete is only checked with a query, so that the log does not collect deletes of missing edges.
+ */
+int update_hypercsa(const char *input_file, uint64_t op, const char *node_list)
+{
+    UpdateLog log;
+    if (log_open(log, input_file) != 0)
+    {
+        cerr << "Could not open the update log " << log_path(input_file) << "." << endl;
+        return -1;
+    }
+    Edge edge = parse_edge_from_string(node_list);
+    int result = -1;
+    if (edge.size() > 0 && op == LOG_INSERT_EDGE)
+        result = log_append(log, {op, 0, vector<Node>(edge.begin(), edge.end())});
+    else if (edge.size() > 0)
+    {
+        CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+        PreparedHyperGraph prepared(compressed_graph);
+        if (update_edge_exists(prepared, edge))
+            result = log_append(log, {op, 0, vector<Node>(edge.begin(), edge.end())});
+    }
+    log_close(log);
+    if (result != 0)
+        cerr << "Update failed." << endl;
+    return result;
+}
+
+int insert_edge_hypercsa(const char *input_file, const char *node_list)
+{
+    return update_hypercsa(input_file, LOG_INSERT_EDGE, node_list);
+}
+
+int delete_edge_hypercsa(const char *input_file, const char *node_list)
+{
+    return update_hypercsa(input_file, LOG_DELETE_EDGE, node_list);
+}
+
+int checkpoint_hypercsa(const char *input_file)
+{
+    int result = log_checkpoint(input_file);
+    if (result != 0)
+        cerr << "Checkpoint failed." << endl;
+    return result;
+}
+
+int stats_hypercsa(const char *input_file)
+{
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+    PreparedHyperGraph prepared(compressed_graph);
+    return write_space_report(prepared, cout);
+}
+
+int degree_hypercsa(const char *input_file, const char *node_list)
+{
+    Edge nodes = parse_edge_from_string(node_list);
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+    PreparedHyperGraph prepared(compressed_graph);
+    vector<Index> degrees = node_degrees(prepared, vector<Node>(nodes.begin(), nodes.end()));
+    for (size_t i = 0; i < degrees.size(); i++)
+        cout << nodes[i] << " " << degrees[i] << endl;
+    return 0;
+}
+
+int top_degrees_hypercsa(const char *input_file, int k, int threads)
+{
+    if (k < 0)
+        return -1;
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+    PreparedHyperGraph prepared(compressed_graph);
+    for (const NodeDegree& node : top_degrees(prepared, k, threads > 0 ? threads : thread::hardware_concurrency()))
+        cout << node.node << " " << node.degree << endl;
+    return 0;
+}
+
+int serve_hypercsa(const char *input_file, const char *socket_path, int threads, int hubs)
+{
+    QueryServer server(load_hyper_csa_with_log(input_file), threads > 0 ? threads : thread::hardware_concurrency());
+    if (hubs > 0)
+        prepared_build_hubs(server.prepared, hubs);
+    if (socket_path == nullptr)
+        return server_serve_stream(server, STDIN_FILENO, STDOUT_FILENO);
+    int result = server_serve_socket(server, socket_path);
+    if (result != 0)
+        cerr << "Could not serve on socket " << socket_path << "." << endl;
+    return result;
+}
+
+double elapsed_ms(chrono::high_resolution_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void compare_dynamic_hypercsa(const char* input_file, int type, const char* test_file)
+{
+    HyperGraph graph;
+    parse_graph(test_file, graph, false);
+    CompressedHyperGraph compressed_graph = load_hyper_csa_with_log(input_file);
+
+    auto start = chrono::high_resolution_clock::now();
+    DynamicHyperGraph dynamic_graph = dynamic_from_static(compressed_graph);
+    cout << "Conversion to dynamic: " << elapsed_ms(start) << "ms." << endl;
+    cout << "Size static : " << size_in_bytes(compressed_graph.D) + size_in_bytes(compressed_graph.PSI) << "bytes." << endl;
+    cout << "Size dynamic: " << dynamic_graph.D.size_in_bytes() + dynamic_graph.L.size_in_bytes() << "bytes." << endl;
+
+    double static_ms = 0, dynamic_ms = 0;
+    { // The supports of the static graph are built once, like the dynamic graph has them, and dropped before the updates.
+        PreparedHyperGraph prepared(compressed_graph);
+        for (Index i = 0; i < graph.edge_count; i++)
+        {
+            start = chrono::high_resolution_clock::now();
+            EdgeList static_result = query(prepared, graph.edges[i], type);
+            static_ms += elapsed_ms(start);
+            start = chrono::high_resolution_clock::now();
+            EdgeList dynamic_result = query(dynamic_graph, graph.edges[i], type);
+            dynamic_ms += elapsed_ms(start);
+            if (static_result.size() != dynamic_result.size())
+                cout << "Query " << i << " differs: " << static_result.size() << " static, " << dynamic_result.size() << " dynamic results." << endl;
+        }
+    }
+    cout << "Queries static : " << static_ms << "ms." << endl;
+    cout << "Queries dynamic: " << dynamic_ms << "ms." << endl;
+
+    if (graph.edge_count > 0)
+    {
+        start = chrono::high_resolution_clock::now();
+        modify_insert_edge(compressed_graph, graph.edges[0]);
+        cout << "Insert edge static : " << elapsed_ms(start) << "ms." << endl;
+        start = chrono::high_resolution_clock::now();
+        dynamic_insert_edge(dynamic_graph, graph.edges[0]);
+        cout << "Insert edge dynamic: " << elapsed_ms(start) << "ms." << endl;
     }
+    start = chrono::high_resolution_clock::now();
+    modify_delete_edge(compressed_graph, 0);
+    cout << "Delete edge static : " << elapsed_ms(start) << "ms." << endl;
+    start = chrono::high_resolution_clock::now();
+    dynamic_delete_edge(dynamic_graph, 0);
+    cout << "Delete edge dynamic: " << elapsed_ms(start) << "ms." << endl;
 }
 
 int test_hypercsa_create(const char *output_file)
@@ -274,6 +981,894 @@ int test_hypercsa_insert_edge()
     return 0;
 }
 
+/*
+ * Compares the decompressed edges of the graph with the expected edges, both as sorted nodes in any order, and checks
+ * that PSI is still increasing within each interval of D.
+ */
+int test_expect_edges(CompressedHyperGraph &graph, vector<vector<Node>> expected, const char *name)
+{
+    vector<vector<Node>> edges;
+    for (Edge &e : decompress_all_edges(graph))
+    {
+        edges.emplace_back(e.begin(), e.end());
+        sort(edges.back().begin(), edges.back().end());
+    }
+    for (vector<Node> &e : expected)
+        sort(e.begin(), e.end());
+    sort(edges.begin(), edges.end());
+    sort(expected.begin(), expected.end());
+    if (edges != expected || !check_and_print_sanity(graph))
+    {
+        cout << name << " failed." << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// The nodes of the deleted position are its interval in D, rank(pos + 1) - 1.
+int test_hypercsa_delete_node_roundtrip()
+{
+    HyperGraph graph;
+    test_graph(graph);
+    CompressedHyperGraph compressed_graph = construct(graph);
+    modify_delete_node_from_edge(compressed_graph, modify_find_edge(compressed_graph, {0, 1, 2, 4}), 1);
+    if (test_expect_edges(compressed_graph, {{0, 1, 2, 3}, {1, 2, 3}, {2}, {0, 2, 4}, {2}}, "Delete node 1 of {0, 1, 2, 4}") != 0)
+        return -1;
+    modify_delete_node_from_edge(compressed_graph, modify_find_edge(compressed_graph, {0, 1, 2, 3}), 3);
+    return test_expect_edges(compressed_graph, {{0, 1, 2}, {1, 2, 3}, {2}, {0, 2, 4}, {2}}, "Delete node 3 of {0, 1, 2, 3}");
+}
+
+// The new node goes behind the largest smaller node of the edge, which is found from the start of the walk.
+int test_hypercsa_insert_node_roundtrip()
+{
+    HyperGraph graph;
+    test_graph(graph);
+    CompressedHyperGraph compressed_graph = construct(graph);
+    modify_insert_node_to_edge(compressed_graph, modify_find_edge(compressed_graph, {1, 2, 3}), 0);
+    if (test_expect_edges(compressed_graph, {{0, 1, 2, 3}, {0, 1, 2, 3}, {2}, {0, 1, 2, 4}, {2}}, "Insert node 0 into {1, 2, 3}") != 0)
+        return -1;
+    modify_insert_node_to_edge(compressed_graph, modify_find_edge(compressed_graph, {0, 1, 2, 4}), 3);
+    if (test_expect_edges(compressed_graph, {{0, 1, 2, 3}, {0, 1, 2, 3}, {2}, {0, 1, 2, 3, 4}, {2}}, "Insert node 3 into {0, 1, 2, 4}") != 0)
+        return -1;
+    modify_insert_node_to_edge(compressed_graph, modify_find_edge(compressed_graph, {2}), 4);
+    if (test_expect_edges(compressed_graph, {{0, 1, 2, 3}, {0, 1, 2, 3}, {2, 4}, {0, 1, 2, 3, 4}, {2}}, "Insert node 4 into {2}") != 0)
+        return -1;
+    modify_insert_node_to_edge(compressed_graph, modify_find_edge(compressed_graph, {2, 4}), 1);
+    return test_expect_edges(compressed_graph, {{0, 1, 2, 3}, {0, 1, 2, 3}, {1, 2, 4}, {0, 1, 2, 3, 4}, {2}}, "Insert node 1 into {2, 4}");
+}
+
+// The positions behind the new one move by one, also the ones of the edge that gets the node.
+int test_hypercsa_insert_node_shift()
+{
+    HyperGraph graph;
+    graph.edges = {Edge{2, 3}, Edge{1, 3}, Edge{0, 1}};
+    graph.edge_count = graph.edges.size();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    modify_insert_node_to_edge(compressed_graph, modify_find_edge(compressed_graph, {2, 3}), 0);
+    if (test_expect_edges(compressed_graph, {{0, 2, 3}, {1, 3}, {0, 1}}, "Insert node 0 into {2, 3}") != 0)
+        return -1;
+    if (modify_find_edge(compressed_graph, {0, 2, 3}) == (Index) -1 || query(compressed_graph, {0}, CONTAIN).size() != 2)
+    {
+        cout << "Insert node 0 into {2, 3}: the edge is not found." << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// The lookup compares every node of the cycle, so prefixes and edges with the same first node are not found.
+int test_hypercsa_find_edge()
+{
+    HyperGraph graph;
+    test_graph(graph);
+    CompressedHyperGraph compressed_graph = construct(graph);
+    vector<Edge> present = {{0, 1, 2, 3}, {1, 2, 3}, {2}, {0, 1, 2, 4}};
+    vector<Edge> absent = {{0, 1, 2}, {0, 1, 3}, {0, 2, 4}, {1, 2}, {2, 3}, {0, 1, 2, 3, 4}};
+    for (Edge &edge : present)
+        if (modify_find_edge(compressed_graph, edge) == (Index) -1)
+        {
+            cout << "Find edge: a present edge is not found." << endl;
+            return -1;
+        }
+    for (Edge &edge : absent)
+        if (modify_find_edge(compressed_graph, edge) != (Index) -1)
+        {
+            cout << "Find edge: an absent edge is found." << endl;
+            return -1;
+        }
+    modify_delete_edge(compressed_graph, modify_find_edge(compressed_graph, {0, 1, 2, 3}));
+    return test_expect_edges(compressed_graph, {{1, 2, 3}, {2}, {0, 1, 2, 4}, {2}}, "Delete edge {0, 1, 2, 3}");
+}
+
+// The interval of node 2 starts right behind the one of node 1, so an inclusive end of the interval of node 1 would
+// let the exact query of {0, 1} return {0, 2}.
+int test_hypercsa_exact_interval_end()
+{
+    HyperGraph graph;
+    graph.edges = {Edge{1}, Edge{0, 2}};
+    graph.edge_count = graph.edges.size();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    if (!query(prepared, {0, 1}, EXACT).empty())
+    {
+        cout << "Exact query of {0, 1} returned an edge with another last node." << endl;
+        return -1;
+    }
+    if (query(prepared, {0, 2}, EXACT).size() != 1 || query(prepared, {1}, EXACT).size() != 1)
+    {
+        cout << "Exact query missed an edge." << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// The new node 1 goes to the end of its interval and the new node 2 to the start of the next one, so both are
+// inserted before the same old position.
+int test_hypercsa_insert_edge_same_position()
+{
+    HyperGraph graph;
+    graph.edges = {Edge{2}, Edge{0, 1}, Edge{1}};
+    graph.edge_count = graph.edges.size();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    modify_insert_edge(compressed_graph, {1, 2});
+    if (test_expect_edges(compressed_graph, {{2}, {0, 1}, {1}, {1, 2}}, "Insert edge {1, 2}") != 0)
+        return -1;
+    modify_insert_edge(compressed_graph, {0, 1, 2});
+    return test_expect_edges(compressed_graph, {{2}, {0, 1}, {1}, {1, 2}, {0, 1, 2}}, "Insert edge {0, 1, 2}");
+}
+
+// Both backends insert a node that is given twice once.
+int test_hypercsa_insert_edge_duplicates()
+{
+    HyperGraph graph;
+    test_graph(graph);
+    CompressedHyperGraph compressed_graph = construct(graph);
+    DynamicHyperGraph dynamic_graph = dynamic_from_static(compressed_graph);
+    modify_insert_edge(compressed_graph, {3, 1, 3});
+    dynamic_insert_edge(dynamic_graph, {3, 1, 3});
+    CompressedHyperGraph converted = dynamic_to_static(dynamic_graph);
+    vector<vector<Node>> expected = {{0, 1, 2, 3}, {1, 2, 3}, {2}, {0, 1, 2, 4}, {2}, {1, 3}};
+    if (test_expect_edges(compressed_graph, expected, "Static insert of {3, 1, 3}") != 0)
+        return -1;
+    return test_expect_edges(converted, expected, "Dynamic insert of {3, 1, 3}");
+}
+
+// A pinned version keeps answering with its own graph while the next versions are published.
+int test_hypercsa_snapshot()
+{
+    HyperGraph graph;
+    test_graph(graph);
+    SnapshotHyperGraph sgraph(construct(graph));
+    GraphVersion pinned = snapshot_pin(sgraph);
+    if (snapshot_insert_edge(sgraph, {3, 1}) != 0 || snapshot_delete_edge(sgraph, {1, 2, 3}) != 0
+        || snapshot_insert_node_to_edge(sgraph, {1, 3}, 0) != 0 || snapshot_delete_edge(sgraph, {1, 2, 3}) != -1)
+    {
+        cout << "Snapshot updates failed." << endl;
+        return -1;
+    }
+    if (snapshot_version(sgraph) != 3 || snapshot_query(sgraph, {0, 1, 3}, EXACT).size() != 1
+        || query(pinned->prepared, {0, 1, 3}, EXACT).size() != 0)
+    {
+        cout << "Snapshot queries answered with the wrong version." << endl;
+        return -1;
+    }
+    if (test_expect_edges(pinned->graph, {{0, 1, 2, 3}, {1, 2, 3}, {2}, {0, 1, 2, 4}, {2}}, "Pinned snapshot") != 0)
+        return -1;
+    return test_expect_edges(snapshot_pin(sgraph)->graph, {{0, 1, 2, 3}, {2}, {0, 1, 2, 4}, {2}, {0, 1, 3}},
+                             "Current snapshot");
+}
+
+int test_hypercsa_delta_delete_prefix()
+{
+    // The exact query of {0, 1, 2, 3} also returns {0, 1, 2, 3, 4}, but there is no such edge to delete.
+    HyperGraph graph;
+    graph.edges = {Edge{1, 2, 3}, Edge{0, 1, 2}, Edge{0, 1, 2, 3, 4}, Edge{0, 2, 3}};
+    graph.edge_count = graph.edges.size();
+    DeltaHyperGraph dgraph(construct(graph));
+
+    Edge prefix = {0, 1, 2, 3};
+    if (delta_delete_edge(dgraph, prefix) != -1)
+    {
+        cout << "Delta delete of a prefix of a base edge did not fail." << endl;
+        return -1;
+    }
+    delta_insert_edge(dgraph, prefix);
+    Index found = 0;
+    for (Edge &e : delta_query(dgraph, prefix, EXACT))
+    {
+        sort(e.begin(), e.end());
+        found += e == prefix;
+    }
+    if (found != 1)
+    {
+        cout << "Delta query found the inserted prefix " << found << " times." << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// A small graph with hubs and repeated edges, for the comparisons with a brute force over the decompressed edges.
+HyperGraph test_power_law_graph()
+{
+    GeneratorConfig config;
+    config.nodes = 60;
+    config.edges = 400;
+    config.max_size = 6;
+    config.degree_exponent = 1.5;
+    config.duplicate_rate = 0.1;
+    config.threads = 1;
+    return generate_hypergraph(config);
+}
+
+// The sorted nodes of each edge, in id order.
+vector<vector<Node>> test_edges_by_id(PreparedHyperGraph &prepared)
+{
+    vector<vector<Node>> edges;
+    for (Index id = 0; id < prepared.edges; id++)
+    {
+        Edge edge = decompress_edge_by_id(prepared, id);
+        edges.emplace_back(edge.begin(), edge.end());
+    }
+    return edges;
+}
+
+// Queries of some nodes of an edge, a random node and a node outside of the graph.
+Edge test_random_query(const vector<vector<Node>> &edges, Index nodes, mt19937_64 &random)
+{
+    vector<Node> picked;
+    for (Node node : edges[random() % edges.size()])
+        if (random() % 2 == 0)
+            picked.push_back(node);
+    if (random() % 2 == 0)
+        picked.push_back(random() % nodes);
+    if (random() % 8 == 0)
+        picked.push_back(nodes + 1);
+    Edge query(picked.size());
+    copy(picked.begin(), picked.end(), query.begin());
+    return query;
+}
+
+int test_hypercsa_jaccard()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    vector<vector<Node>> edges = test_edges_by_id(prepared);
+    mt19937_64 random(1);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1)
+            prepared_build_samples(prepared, 2);
+        for (int i = 0; i < 100; i++)
+        {
+            Edge query = test_random_query(edges, prepared.nodes, random);
+            vector<Node> nodes(query.begin(), query.end());
+            sort(nodes.begin(), nodes.end());
+            nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+            vector<SimilarEdge> expected;
+            for (Index id = 0; id < edges.size(); id++)
+            {
+                vector<Node> distinct = edges[id];
+                distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+                uint64_t shared = 0;
+                for (Node node : distinct)
+                    shared += binary_search(nodes.begin(), nodes.end(), node);
+                if (shared > 0)
+                    expected.push_back({id, shared, nodes.size() + edges[id].size() - shared, 0.0});
+            }
+            sort(expected.begin(), expected.end(), [](const SimilarEdge &a, const SimilarEdge &b) {
+                uint64_t left = a.shared * b.union_size, right = b.shared * a.union_size;
+                return left != right ? left > right : a.id < b.id;
+            });
+            for (uint64_t k : {1, 3, 1000})
+            {
+                for (unsigned threads : {1u, 2u})
+                {
+                    vector<SimilarEdge> best = query_jaccard(prepared, query, k, threads);
+                    bool same = best.size() == min<size_t>(k, expected.size());
+                    for (size_t j = 0; same && j < best.size(); j++)
+                        same = best[j].id == expected[j].id && best[j].shared == expected[j].shared
+                               && best[j].union_size == expected[j].union_size;
+                    if (!same)
+                    {
+                        cout << "Jaccard query with k = " << k << " differs from the brute force." << endl;
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Random inserts and erases on a DynamicBitVector against a vector<bool>, enough to split and merge blocks.
+int test_hypercsa_dynamic_bit_vector()
+{
+    mt19937_64 random(3);
+    sdsl::bit_vector initial(3000, 0);
+    vector<bool> expected(initial.size());
+    for (Index i = 0; i < initial.size(); i++)
+        expected[i] = initial[i] = random() % 3 == 0;
+    DynamicBitVector bv(initial);
+    for (int op = 0; op < 20000; op++)
+    {
+        if (op == 10000)
+            bv = DynamicBitVector(bv); // The copy must behave the same.
+        if (expected.empty() || random() % 5 < (op < 10000 ? 3u : 2u))
+        {
+            Index i = random() % (expected.size() + 1);
+            bool bit = random() % 3 == 0;
+            bv.insert(i, bit);
+            expected.insert(expected.begin() + i, bit);
+        }
+        else
+        {
+            Index i = random() % expected.size();
+            bv.erase(i);
+            expected.erase(expected.begin() + i);
+        }
+        bool full = op % 1000 == 999;
+        Index ones = 0, zeros = 0;
+        for (Index i = 0; i <= expected.size(); i++)
+        {
+            bool check = full || random() % 500 == 0;
+            if (check && (bv.rank1(i) != ones || bv.rank0(i) != zeros))
+            {
+                cout << "DynamicBitVector rank differs after " << op << " operations." << endl;
+                return -1;
+            }
+            if (i == expected.size())
+                break;
+            if (check && bv[i] != expected[i])
+            {
+                cout << "DynamicBitVector access differs after " << op << " operations." << endl;
+                return -1;
+            }
+            expected[i] ? ones++ : zeros++;
+            if (check && (expected[i] ? bv.select1(ones) : bv.select0(zeros)) != i)
+            {
+                cout << "DynamicBitVector select differs after " << op << " operations." << endl;
+                return -1;
+            }
+        }
+        if (bv.size() != expected.size() || bv.ones() != ones)
+        {
+            cout << "DynamicBitVector size differs after " << op << " operations." << endl;
+            return -1;
+        }
+    }
+    sdsl::bit_vector converted = bv.to_bit_vector();
+    for (Index i = 0; i < expected.size(); i++)
+        if (converted[i] != expected[i])
+        {
+            cout << "DynamicBitVector conversion differs." << endl;
+            return -1;
+        }
+    return 0;
+}
+
+// Random inserts and erases on a DynamicSequence against a vector, with symbols that make the width grow.
+int test_hypercsa_dynamic_sequence()
+{
+    mt19937_64 random(4);
+    vector<uint64_t> expected(2000);
+    for (uint64_t &value : expected)
+        value = random() % 8;
+    DynamicSequence sequence(expected);
+    for (int op = 0; op < 6000; op++)
+    {
+        uint64_t sigma = op < 2000 ? 8 : op < 4000 ? 100 : 5000;
+        if (expected.empty() || random() % 5 < 3)
+        {
+            Index i = random() % (expected.size() + 1);
+            uint64_t c = random() % sigma;
+            sequence.insert(i, c);
+            expected.insert(expected.begin() + i, c);
+        }
+        else
+        {
+            Index i = random() % expected.size();
+            sequence.erase(i);
+            expected.erase(expected.begin() + i);
+        }
+        if (sequence.size() != expected.size())
+        {
+            cout << "DynamicSequence size differs after " << op << " operations." << endl;
+            return -1;
+        }
+        for (int probe = 0; probe < 4 && !expected.empty(); probe++)
+        {
+            Index i = random() % expected.size();
+            uint64_t c = probe % 2 == 0 ? expected[i] : random() % sigma;
+            Index count = std::count(expected.begin(), expected.begin() + i, c);
+            if (sequence[i] != expected[i] || sequence.rank(c, i) != count)
+            {
+                cout << "DynamicSequence access or rank differs after " << op << " operations." << endl;
+                return -1;
+            }
+            if (expected[i] == c && sequence.select(c, count + 1) != i)
+            {
+                cout << "DynamicSequence select differs after " << op << " operations." << endl;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// The results as sorted lists of sorted nodes, to compare results that come in a different order.
+vector<vector<Node>> test_sorted_edges(EdgeList edges)
+{
+    vector<vector<Node>> sorted;
+    for (Edge &edge : edges)
+    {
+        sort(edge.begin(), edge.end());
+        sorted.emplace_back(edge.begin(), edge.end());
+    }
+    sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+// The edges for which match holds, sorted like test_sorted_edges.
+vector<vector<Node>> test_matching_edges(const vector<vector<Node>> &edges, const function<bool(const vector<Node> &)> &match)
+{
+    vector<vector<Node>> matching;
+    for (const vector<Node> &edge : edges)
+        if (match(edge))
+            matching.push_back(edge);
+    sort(matching.begin(), matching.end());
+    return matching;
+}
+
+// The dynamic graph answers every query type like the prepared static graph.
+int test_hypercsa_dynamic_queries()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    DynamicHyperGraph dynamic_graph = dynamic_from_static(compressed_graph);
+    vector<vector<Node>> edges = test_edges_by_id(prepared);
+    mt19937_64 random(2);
+    for (int i = 0; i < 100; i++)
+    {
+        Edge query = test_random_query(edges, prepared.nodes, random);
+        if (query.size() == 0)
+            continue;
+        for (int type : {EXACT, CONTAIN, SUBSET, OVERLAP, PREFIX, RANGE})
+        {
+            Edge typed = query;
+            if (type == RANGE)
+                typed = {query[0], query[query.size() - 1]};
+            if (test_sorted_edges(::query(prepared, typed, type)) != test_sorted_edges(::query(dynamic_graph, typed, type)))
+            {
+                cout << "Dynamic query of type " << type << " differs from the static one." << endl;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Subset queries against a brute force over the decompressed edges, also with an empty query.
+int test_hypercsa_subset()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    vector<vector<Node>> edges = test_edges_by_id(prepared);
+    mt19937_64 random(4);
+    for (int i = 0; i < 200; i++)
+    {
+        Edge query = test_random_query(edges, prepared.nodes, random);
+        for (int extra = random() % 8; extra > 0; extra--) // Larger queries contain some edges of other nodes.
+        {
+            query.resize(query.size() + 1);
+            query[query.size() - 1] = random() % prepared.nodes;
+        }
+        vector<Node> nodes(query.begin(), query.end());
+        sort(nodes.begin(), nodes.end());
+        vector<vector<Node>> expected = test_matching_edges(edges, [&](const vector<Node> &edge) {
+            return all_of(edge.begin(), edge.end(), [&](Node node) {
+                return binary_search(nodes.begin(), nodes.end(), node);
+            });
+        });
+        if (test_sorted_edges(::query(prepared, query, SUBSET)) != expected
+            || query_count(prepared, query, SUBSET) != expected.size())
+        {
+            cout << "Subset query differs from the brute force." << endl;
+            return -1;
+        }
+    }
+    if (!::query(prepared, {}, SUBSET).empty())
+    {
+        cout << "Subset query of no nodes returned edges." << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// Overlap queries against a brute force, with thresholds up to one more than the distinct query nodes.
+int test_hypercsa_overlap()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    vector<vector<Node>> edges = test_edges_by_id(prepared);
+    mt19937_64 random(5);
+    for (int i = 0; i < 200; i++)
+    {
+        Edge query = test_random_query(edges, prepared.nodes, random);
+        vector<Node> nodes(query.begin(), query.end());
+        sort(nodes.begin(), nodes.end());
+        nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+        for (uint64_t threshold = 0; threshold <= nodes.size() + 1; threshold++)
+        {
+            vector<vector<Node>> expected = test_matching_edges(edges, [&](const vector<Node> &edge) {
+                vector<Node> distinct = edge;
+                distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+                uint64_t shared = 0;
+                for (Node node : distinct)
+                    shared += binary_search(nodes.begin(), nodes.end(), node);
+                return shared >= max<uint64_t>(threshold, 1);
+            });
+            if (test_sorted_edges(query_overlap(prepared, query, threshold)) != expected
+                || query_overlap_count(prepared, query, threshold) != expected.size())
+            {
+                cout << "Overlap query with threshold " << threshold << " differs from the brute force." << endl;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Contains queries with excluded nodes against a brute force, also with excluded nodes that are required as well.
+int test_hypercsa_boolean()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    vector<vector<Node>> edges = test_edges_by_id(prepared);
+    mt19937_64 random(6);
+    for (int i = 0; i < 200; i++)
+    {
+        Edge required = test_random_query(edges, prepared.nodes, random);
+        if (required.size() == 0)
+            continue;
+        Edge excluded(random() % 4);
+        for (Node &node : excluded)
+            node = random() % prepared.nodes;
+        if (random() % 4 == 0)
+        {
+            excluded.resize(excluded.size() + 1);
+            excluded[excluded.size() - 1] = required[random() % required.size()];
+        }
+        vector<Node> nodes(required.begin(), required.end()); // A node required twice must be in the edge twice.
+        sort(nodes.begin(), nodes.end());
+        vector<vector<Node>> expected = test_matching_edges(edges, [&](const vector<Node> &edge) {
+            return includes(edge.begin(), edge.end(), nodes.begin(), nodes.end())
+                   && none_of(excluded.begin(), excluded.end(), [&](Node node) {
+                       return binary_search(edge.begin(), edge.end(), node);
+                   });
+        });
+        if (test_sorted_edges(query_boolean(prepared, required, excluded)) != expected
+            || query_boolean_count(prepared, required, excluded) != expected.size())
+        {
+            cout << "Contains query with excluded nodes differs from the brute force." << endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Prefix and range queries against a brute force, also with ranges whose bounds are swapped or outside of the graph.
+int test_hypercsa_prefix_range()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    PreparedHyperGraph prepared(compressed_graph);
+    vector<vector<Node>> edges = test_edges_by_id(prepared);
+    mt19937_64 random(7);
+    for (int i = 0; i < 200; i++)
+    {
+        Edge query = test_random_query(edges, prepared.nodes, random);
+        vector<Node> nodes(query.begin(), query.end());
+        sort(nodes.begin(), nodes.end());
+        vector<vector<Node>> expected = test_matching_edges(edges, [&](const vector<Node> &edge) {
+            return !nodes.empty() && edge.size() >= nodes.size() && equal(nodes.begin(), nodes.end(), edge.begin());
+        });
+        if (test_sorted_edges(::query(prepared, query, PREFIX)) != expected
+            || query_count(prepared, query, PREFIX) != expected.size())
+        {
+            cout << "Prefix query differs from the brute force." << endl;
+            return -1;
+        }
+
+        Edge range = {random() % (prepared.nodes + 2), random() % (prepared.nodes + 2)};
+        if (random() % 2 == 0 && range[0] > range[1])
+            swap(range[0], range[1]);
+        expected = test_matching_edges(edges, [&](const vector<Node> &edge) {
+            return range[0] <= range[1] && range[0] <= edge.front() && edge.back() <= range[1];
+        });
+        if (test_sorted_edges(::query(prepared, range, RANGE)) != expected
+            || query_count(prepared, range, RANGE) != expected.size())
+        {
+            cout << "Range query [" << range[0] << ", " << range[1] << "] differs from the brute force." << endl;
+            return -1;
+        }
+    }
+    if (!::query(prepared, {}, PREFIX).empty() || !::query(prepared, {}, RANGE).empty())
+    {
+        cout << "Prefix or range query of no nodes returned edges." << endl;
+        return -1;
+    }
+    return 0;
+}
+
+// The neighbors of each node by a brute force over the edges, in the order of query_neighbors.
+vector<Neighbor> test_neighbors(const vector<vector<Node>> &edges, Node node)
+{
+    map<Node, uint64_t> counts;
+    for (const vector<Node> &edge : edges)
+    {
+        uint64_t occurrences = count(edge.begin(), edge.end(), node); // Each occurrence walks the whole cycle.
+        for (Node neighbor : edge)
+            if (neighbor != node && occurrences > 0)
+                counts[neighbor] += occurrences;
+    }
+    vector<Neighbor> neighbors;
+    for (auto &entry : counts)
+        neighbors.push_back({entry.first, entry.second});
+    stable_sort(neighbors.begin(), neighbors.end(), [](const Neighbor &a, const Neighbor &b) { return a.count > b.count; });
+    return neighbors;
+}
+
+// Neighborhood queries against a brute force, also of a hub that is large enough to be walked by several threads.
+int test_hypercsa_neighbors()
+{
+    HyperGraph graph = test_power_law_graph();
+    HyperGraph star; // Node 0 is in every edge, some edges have it twice.
+    mt19937_64 random(8);
+    for (int i = 0; i < 5000; i++)
+        star.edges.push_back(i % 7 == 0 ? Edge{0, 0, random() % 50 + 1} : Edge{0, random() % 50 + 1, random() % 50 + 1});
+    star.edge_count = star.edges.size();
+    for (HyperGraph *tested : {&graph, &star})
+    {
+        CompressedHyperGraph compressed_graph = construct(*tested);
+        PreparedHyperGraph prepared(compressed_graph);
+        vector<vector<Node>> edges = test_edges_by_id(prepared);
+        for (Node node = 0; node <= prepared.nodes; node++)
+        {
+            vector<Neighbor> expected = test_neighbors(edges, node);
+            for (uint64_t k : {0, 1, 5})
+            {
+                for (unsigned threads : {1u, 4u})
+                {
+                    vector<Neighbor> neighbors = query_neighbors(prepared, node, k, threads);
+                    bool same = neighbors.size() == (k == 0 ? expected.size() : min<size_t>(k, expected.size()));
+                    for (size_t j = 0; same && j < neighbors.size(); j++)
+                        same = neighbors[j].node == expected[j].node && neighbors[j].count == expected[j].count;
+                    if (!same)
+                    {
+                        cout << "Neighbors of node " << node << " with k = " << k << " differ from the brute force." << endl;
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Degrees and top degrees against counts over the edges, also on a graph with enough nodes to be split into ranges.
+int test_hypercsa_degrees()
+{
+    HyperGraph graph = test_power_law_graph();
+    HyperGraph wide;
+    mt19937_64 random(9);
+    for (Node node = 0; node < 10000; node++)
+        wide.edges.push_back(Edge{node, random() % 10000, random() % 50});
+    wide.edge_count = wide.edges.size();
+    for (HyperGraph *tested : {&graph, &wide})
+    {
+        CompressedHyperGraph compressed_graph = construct(*tested);
+        PreparedHyperGraph prepared(compressed_graph);
+        vector<Index> expected(prepared.nodes + 2, 0); // The last two nodes are outside of the graph.
+        for (const vector<Node> &edge : test_edges_by_id(prepared))
+            for (Node node : edge)
+                expected[node]++;
+        vector<Node> nodes(expected.size());
+        for (Node node = 0; node < nodes.size(); node++)
+            nodes[node] = node;
+        if (node_degrees(prepared, nodes) != expected || node_degree(prepared, prepared.nodes) != 0)
+        {
+            cout << "Node degrees differ from the counts over the edges." << endl;
+            return -1;
+        }
+        vector<NodeDegree> ranked;
+        for (Node node = 0; node < prepared.nodes; node++)
+            ranked.push_back({node, expected[node]});
+        stable_sort(ranked.begin(), ranked.end(), [](const NodeDegree &a, const NodeDegree &b) {
+            return a.degree > b.degree;
+        });
+        for (uint64_t k : {(uint64_t) 0, (uint64_t) 1, (uint64_t) 10, prepared.nodes, prepared.nodes + 5})
+        {
+            for (unsigned threads : {1u, 4u})
+            {
+                vector<NodeDegree> top = top_degrees(prepared, k, threads);
+                bool same = top.size() == min<uint64_t>(k, prepared.nodes);
+                for (size_t j = 0; same && j < top.size(); j++)
+                    same = top[j].node == ranked[j].node && top[j].degree == ranked[j].degree;
+                if (!same)
+                {
+                    cout << "Top degrees with k = " << k << " differ from the counts over the edges." << endl;
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// The stable ids of the edges that were not deleted resolve to the same edges after random modifications, and the
+// deleted ids to none. The inserts push the ranks beyond the width of the first id ranks.
+int test_hypercsa_stable_ids()
+{
+    HyperGraph graph = test_power_law_graph();
+    CompressedHyperGraph compressed_graph = construct(graph);
+    vector<vector<Node>> expected;
+    Index nodes;
+    {
+        PreparedHyperGraph prepared(compressed_graph);
+        expected = test_edges_by_id(prepared); // The ids of a new graph are the ranks in E.
+        nodes = prepared.nodes;
+    }
+    mt19937_64 random(10);
+    for (int i = 0; i < 400; i++)
+    {
+        Index id = random() % expected.size();
+        if (i % 3 == 0)
+        {
+            Edge edge = {random() % nodes, random() % nodes, random() % nodes};
+            modify_insert_edge(compressed_graph, edge);
+            sort(edge.begin(), edge.end());
+            expected.emplace_back(edge.begin(), unique(edge.begin(), edge.end()));
+        }
+        else if (i % 3 == 1 && !expected[id].empty())
+        {
+            try {
+                modify_delete_edge(compressed_graph, modify_find_id(compressed_graph, id));
+                expected[id].clear();
+            }
+            catch (int) {} // A node would lose its last position, the edge stays.
+        }
+        else if (!expected[id].empty())
+        {
+            Node node = random() % nodes;
+            modify_insert_node_to_edge(compressed_graph, modify_find_id(compressed_graph, id), node);
+            if (!binary_search(expected[id].begin(), expected[id].end(), node))
+                expected[id].insert(lower_bound(expected[id].begin(), expected[id].end(), node), node);
+        }
+
+        PreparedHyperGraph prepared(compressed_graph);
+        for (Index checked = 0; checked < expected.size(); checked++)
+        {
+            Index position = modify_find_id(compressed_graph, checked);
+            bool same = position == stable_position(prepared, checked) && (position == (Index) -1) == expected[checked].empty();
+            if (same && position != (Index) -1)
+            {
+                Edge edge = decompress_edge_by_id(prepared, edge_id(prepared, position));
+                same = vector<Node>(edge.begin(), edge.end()) == expected[checked] && stable_id(prepared, position) == checked;
+            }
+            if (!same)
+            {
+                cout << "Stable id " << checked << " resolves to another edge after " << i + 1 << " modifications." << endl;
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Opens the graph through a temporary file like an FFI caller, or returns NULL.
+hypercsa_index *test_open_index(HyperGraph &graph)
+{
+    char path[] = "/tmp/hypercsa_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return nullptr;
+    close(fd);
+    CompressedHyperGraph compressed_graph = construct(graph);
+    hypercsa_index *index = write_hyper_csa(path, compressed_graph) == 0 ? hypercsa_open(path) : nullptr;
+    unlink(path);
+    return index;
+}
+
+// The handle based API rejects missing handles and buffers, answers on a graph without edges, and a batch returns the
+// results of its queries one after another.
+int test_hypercsa_c_api()
+{
+    uint64_t nodes[] = {0, 1, 2, 3};
+    size_t offsets[] = {0, 2, 3, 4};
+    int64_t counts[3];
+    uint64_t buffer[256], degrees[4];
+    size_t edges, total_nodes;
+    hypercsa_stats stats = {};
+    if (hypercsa_open("/nonexistent/graph.hcsa") != nullptr
+        || hypercsa_count(nullptr, CONTAIN, nodes, 2) != -1 || hypercsa_query(nullptr, CONTAIN, nodes, 2, buffer, 256) != -1
+        || hypercsa_query_csr(nullptr, CONTAIN, nodes, 2, buffer, 256, buffer, 256, &edges, &total_nodes) != -1
+        || hypercsa_count_batch(nullptr, CONTAIN, nodes, offsets, 3, counts) != -1
+        || hypercsa_query_batch(nullptr, CONTAIN, nodes, offsets, 3, counts, buffer, 256) != -1
+        || hypercsa_count_batch_stats(nullptr, CONTAIN, nodes, offsets, 3, counts, &stats) != -1
+        || hypercsa_count_overlap(nullptr, nodes, 2, 1) != -1 || hypercsa_count_boolean(nullptr, nodes, 1, nodes, 1) != -1
+        || hypercsa_degree(nullptr, 0) != -1 || hypercsa_top_degrees(nullptr, 2, 1, nodes, degrees) != -1
+        || hypercsa_edge_count(nullptr) != -1 || hypercsa_edge(nullptr, 0, buffer, 256) != -1
+        || hypercsa_edge_of_stable_id(nullptr, 0) != -1 || hypercsa_build_hubs(nullptr, 1) != -1)
+    {
+        cout << "C API accepted a missing index." << endl;
+        return -1;
+    }
+
+    HyperGraph graph;
+    test_graph(graph);
+    hypercsa_index *index = test_open_index(graph);
+    if (index == nullptr)
+    {
+        cout << "C API could not open the test graph." << endl;
+        return -1;
+    }
+    bool rejected = hypercsa_count(index, CONTAIN, nullptr, 2) == -1 && hypercsa_count(index, RANGE + 1, nodes, 2) == -1
+        && hypercsa_query(index, CONTAIN, nodes, 2, nullptr, 256) == -1
+        && hypercsa_query_csr(index, CONTAIN, nodes, 2, buffer, 256, buffer, 256, nullptr, &total_nodes) == -1
+        && hypercsa_count_batch(index, CONTAIN, nullptr, offsets, 3, counts) == -1
+        && hypercsa_count_batch(index, CONTAIN, nodes, nullptr, 3, counts) == -1
+        && hypercsa_query_batch(index, CONTAIN, nodes, offsets, 3, nullptr, buffer, 256) == -1
+        && hypercsa_query_batch(index, CONTAIN, nodes, offsets, 3, counts, nullptr, 256) == -1
+        && hypercsa_count_boolean(index, nodes, 1, nullptr, 1) == -1
+        && hypercsa_degrees(index, nodes, 4, nullptr) == -1 && hypercsa_edge(index, 100, buffer, 256) == -1;
+
+    // The batch writes the results of each query where hypercsa_query would, one query after another.
+    int64_t words = hypercsa_query_batch(index, CONTAIN, nodes, offsets, 3, counts, buffer, 256);
+    int64_t expected_words = 0;
+    bool same = words > 0 && words <= 256;
+    for (size_t i = 0; same && i < 3; i++)
+    {
+        uint64_t single[256];
+        int64_t single_words = hypercsa_query(index, CONTAIN, nodes + offsets[i], offsets[i + 1] - offsets[i], single, 256);
+        same = counts[i] == hypercsa_count(index, CONTAIN, nodes + offsets[i], offsets[i + 1] - offsets[i])
+               && equal(single, single + single_words, buffer + expected_words);
+        expected_words += single_words;
+    }
+    same = same && words == expected_words;
+    hypercsa_close(index);
+    if (!rejected || !same)
+    {
+        cout << (!rejected ? "C API accepted a missing buffer." : "C API batch differs from the single queries.") << endl;
+        return -1;
+    }
+
+    HyperGraph empty;
+    empty.edge_count = 0;
+    index = test_open_index(empty);
+    if (index == nullptr)
+    {
+        cout << "C API could not open a graph without edges." << endl;
+        return -1;
+    }
+    same = hypercsa_edge_count(index) == 0 && hypercsa_count(index, CONTAIN, nodes, 2) == 0
+           && hypercsa_query(index, SUBSET, nodes, 4, buffer, 256) == 0
+           && hypercsa_query_batch(index, CONTAIN, nodes, offsets, 3, counts, buffer, 256) == 0 && counts[2] == 0
+           && hypercsa_query_batch(index, CONTAIN, nullptr, offsets, 0, counts, nullptr, 0) == 0
+           && hypercsa_degree(index, 0) == 0 && hypercsa_top_degrees(index, 2, 1, nodes, degrees) == 0
+           && hypercsa_edge(index, 0, buffer, 256) == -1;
+    hypercsa_close(index);
+    if (!same)
+    {
+        cout << "C API on a graph without edges failed." << endl;
+        return -1;
+    }
+    return 0;
+}
+
 int test_query(const char *filename)
 {
     CompressedHyperGraph compressed = load_hyper_csa(filename);
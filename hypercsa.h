@@ -5,25 +5,168 @@
 #ifndef HYPERCSA_HYPERCSA_H
 #define HYPERCSA_HYPERCSA_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
+    ///////////// Handle based operations ////////////////////////
+    // An opened index keeps the graph and its rank and select supports in memory until it is closed.
+    // The queries only read the index, so it can be shared by threads. Type 0 is exact query, Type 1 is contains query.
+    // Type 2 is subset, 3 overlap (threshold 1), 4 prefix and 5 range query, whose nodes are the bounds a and b.
+    typedef struct hypercsa_index hypercsa_index;
+
+    hypercsa_index *hypercsa_open(const char *input_file); // Returns NULL if the file can not be loaded.
+    void hypercsa_close(hypercsa_index *index);
+    int64_t hypercsa_count(hypercsa_index *index, int type, const uint64_t *nodes, size_t length); // -1 on invalid
+    // arguments.
+    int64_t hypercsa_query(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                           uint64_t *buffer, size_t capacity); // Writes each result edge as its size followed by
+    // its nodes. Returns the number of words of all results, only the edges that fit completely are written.
+    int hypercsa_query_csr(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                           uint64_t *offsets, size_t offsets_capacity, uint64_t *node_ids, size_t node_ids_capacity,
+                           size_t *edges, size_t *total_nodes); // Writes the results in CSR form: the nodes of edge i
+    // are node_ids[offsets[i]] to node_ids[offsets[i+1]-1]. Sets edges and total_nodes, returns 0 if the results were
+    // written, 1 if the buffers are too small (edges+1 offsets and total_nodes node ids are needed), -1 on invalid
+    // arguments. The buffers are owned by the caller and can be reused. The results are gathered in a buffer of the
+    // calling thread that is kept for the next query, so a query only allocates the copy of its nodes once warm.
+    int hypercsa_query_csr32(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                             uint64_t *offsets, size_t offsets_capacity, uint32_t *node_ids, size_t node_ids_capacity,
+                             size_t *edges, size_t *total_nodes); // The same with 32 bit node ids, -1 if the graph
+    // has more than 2^32 nodes.
+    int hypercsa_count_batch(hypercsa_index *index, int type, const uint64_t *nodes, const size_t *offsets,
+                             size_t queries, int64_t *counts); // Query i has the nodes [offsets[i], offsets[i+1]).
+    int64_t hypercsa_query_batch(hypercsa_index *index, int type, const uint64_t *nodes, const size_t *offsets,
+                                 size_t queries, int64_t *counts, uint64_t *buffer, size_t capacity); // The results
+    // of the queries of hypercsa_count_batch one after another, each edge written as by hypercsa_query, and counts[i]
+    // is the number of edges of query i, -1 if it is invalid. Returns the number of words of all results, only the
+    // edges that fit completely are written. -1 on invalid arguments.
+    int64_t hypercsa_count_sized(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                                 uint64_t min_size, uint64_t max_size); // Counts only the edges with min_size to
+    // max_size nodes, e.g. min_size = max_size = 2 for the pairs that contain a node. -1 on invalid arguments.
+    int64_t hypercsa_query_sized(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                                 uint64_t min_size, uint64_t max_size, uint64_t *buffer, size_t capacity); // The
+    // results of hypercsa_query with min_size to max_size nodes.
+    int64_t hypercsa_count_overlap(hypercsa_index *index, const uint64_t *nodes, size_t length,
+                                   uint64_t threshold); // Counts the edges that share at least threshold of the
+    // distinct nodes. -1 on invalid arguments.
+    int64_t hypercsa_query_overlap(hypercsa_index *index, const uint64_t *nodes, size_t length, uint64_t threshold,
+                                   uint64_t *buffer, size_t capacity); // The edges of hypercsa_count_overlap, written
+    // as by hypercsa_query.
+    int64_t hypercsa_count_boolean(hypercsa_index *index, const uint64_t *nodes, size_t length,
+                                   const uint64_t *excluded, size_t excluded_length); // Counts the edges that contain
+    // all nodes and none of the excluded nodes. -1 on invalid arguments.
+    int64_t hypercsa_query_boolean(hypercsa_index *index, const uint64_t *nodes, size_t length,
+                                   const uint64_t *excluded, size_t excluded_length, uint64_t *buffer,
+                                   size_t capacity); // The edges of hypercsa_count_boolean, written as by hypercsa_query.
+    int64_t hypercsa_top_jaccard(hypercsa_index *index, const uint64_t *nodes, size_t length, size_t k,
+                                 unsigned threads, uint64_t *edge_ids, double *similarities); // Writes the ids (see
+    // hypercsa_edge) and Jaccard similarities of the k edges most similar to the distinct nodes, best first. The
+    // intervals of the nodes are scanned by threads threads. Returns the number of results, at most k, -1 on invalid
+    // arguments.
+    int64_t hypercsa_neighbors(hypercsa_index *index, uint64_t node, size_t k, unsigned threads, uint64_t *nodes,
+                               uint64_t *counts, size_t capacity); // The nodes that share an edge with node and the
+    // number of shared edges, by decreasing count, only the first k unless k is 0. Returns the number of neighbors, they
+    // are written if they fit. Nodes with many edges are walked by threads threads. -1 on invalid arguments.
+    int64_t hypercsa_degree(hypercsa_index *index, uint64_t node); // The number of edges of the node, from D in
+    // O(1), 0 for nodes outside of the graph. -1 on invalid arguments.
+    int hypercsa_degrees(hypercsa_index *index, const uint64_t *nodes, size_t length, uint64_t *degrees); // The
+    // degrees of length nodes. -1 on invalid arguments.
+    int64_t hypercsa_top_degrees(hypercsa_index *index, size_t k, unsigned threads, uint64_t *nodes,
+                                 uint64_t *degrees); // The k nodes with the highest degree and their degrees, by
+    // decreasing degree, in one pass over D by threads threads. Returns their number, -1 on invalid arguments.
+    int64_t hypercsa_cardinality_histogram(hypercsa_index *index, uint64_t *counts, size_t capacity); // counts[k] is
+    // the number of edges with k nodes. Returns the largest size + 1, the counts are written if they fit.
+
+    // Work done by queries, see QueryStats in read/read.hpp. Only counted if the library is built with QUERY_STATS.
+    typedef struct hypercsa_stats {
+        uint64_t queries, results, psi_accesses, rank_calls, select_calls;
+        uint64_t cycles_examined, cycles_pruned, edges_decompressed, postings_read;
+        uint64_t interval_ns, scan_ns;
+    } hypercsa_stats;
+
+    int64_t hypercsa_edge_count(hypercsa_index *index); // -1 on invalid arguments.
+    int64_t hypercsa_edge(hypercsa_index *index, uint64_t edge_id, uint64_t *nodes, size_t capacity); // Writes the
+    // sorted nodes of the edge with id in [0, hypercsa_edge_count) if they fit. Returns the number of nodes, -1 on
+    // invalid arguments. The ids follow the largest node of the edges and change if the graph is modified.
+    int64_t hypercsa_stable_id(hypercsa_index *index, uint64_t edge_id); // The stable id of the edge, which stays
+    // the same when the file is modified. -1 on invalid arguments.
+    int64_t hypercsa_edge_of_stable_id(hypercsa_index *index, uint64_t stable_id); // The edge id for hypercsa_edge,
+    // -1 if the stable id was deleted or on invalid arguments.
+    int hypercsa_stats_enabled(void); // 1 if the library counts, 0 otherwise.
+    int hypercsa_build_hubs(hypercsa_index *index, size_t k); // Builds posting lists for the k nodes with the highest
+    // degree, so contains queries of only these nodes intersect the lists. Not thread-safe with running queries.
+    int hypercsa_build_edge_samples(hypercsa_index *index, size_t rate); // Samples every rate-th position of each
+    // edge, so hypercsa_edges_equal and the hub build take less than rate steps per position. Not thread-safe with
+    // running queries.
+    int hypercsa_edges_equal(hypercsa_index *index, uint64_t position1, uint64_t position2); // 1 if both positions
+    // of PSI belong to the same edge, 0 if not, -1 on invalid arguments.
+    int64_t hypercsa_space_report(hypercsa_index *index, char *buffer, size_t capacity); // Writes the JSON space
+    // report of read/report.hpp as a null-terminated string if it fits. Returns its length without the terminator, -1
+    // on invalid arguments.
+    int hypercsa_query_csr_stats(hypercsa_index *index, int type, const uint64_t *nodes, size_t length,
+                                 uint64_t *offsets, size_t offsets_capacity, uint64_t *node_ids, size_t node_ids_capacity,
+                                 size_t *edges, size_t *total_nodes, hypercsa_stats *stats); // hypercsa_query_csr,
+    // that adds the work of the query to stats.
+    int hypercsa_count_batch_stats(hypercsa_index *index, int type, const uint64_t *nodes, const size_t *offsets,
+                                   size_t queries, int64_t *counts, hypercsa_stats *stats); // hypercsa_count_batch,
+    // that adds the work of all queries to stats.
+
     ///////////// Test and CLI related operations ////////////////////////
     int construct_hypercsa(const char *input_file, const char *output_file);
-    int query_hypercsa(const char *input_file, int type, const char *node_query); //node_query is expected
-    // to be a comma-separated list of numbers.
-    void query_hypercsa_from_file(const char* input_file, int type, const char* test_file);
+    int query_hypercsa(const char *input_file, int type, const char *node_query, int threshold); //node_query is
+    // expected to be a comma-separated list of numbers. threshold is only used by the overlap query (type 3). The
+    // contains query (type 1) excludes the nodes marked with '!', e.g. "1,2,!7", also in the file of the next function.
+    void query_hypercsa_from_file(const char* input_file, int type, const char* test_file, int threshold);
+    int latency_hypercsa_from_file(const char* input_file, int type, const char* test_file, int json, int hubs); //
+    // Runs the queries of the file and prints p50/p90/p99/p99.9 of their latency by query size, as text or as JSON.
+    // With hubs > 0, posting lists of that many hubs are built first, see hypercsa_build_hubs.
+    void compare_dynamic_hypercsa(const char* input_file, int type, const char* test_file); // Runs the queries
+    // and an insert and delete on the static and on the dynamic representation and prints the times.
+    int insert_edge_hypercsa(const char *input_file, const char *node_list); // Appends the update to the log of the
+    int delete_edge_hypercsa(const char *input_file, const char *node_list); // file instead of rewriting it.
+    int checkpoint_hypercsa(const char *input_file); // Folds the update log into the file.
+    int stats_hypercsa(const char *input_file); // Prints the JSON space report of read/report.hpp.
+    int degree_hypercsa(const char *input_file, const char *node_list); // Prints each node with its degree.
+    int top_degrees_hypercsa(const char *input_file, int k, int threads); // Prints the k nodes with the highest
+    // degree and their degree, threads <= 0 uses all cores.
+    int serve_hypercsa(const char *input_file, const char *socket_path, int threads, int hubs); // Loads the file
+    // once and answers queries on stdin/stdout, or on the Unix socket if socket_path is not NULL. See
+    // read/server.hpp. With hubs > 0, posting lists of that many hubs are built first, see hypercsa_build_hubs.
 
     int test_hypercsa_create(const char *output_file);
     int test_hypercsa_delete_edge();
     int test_hypercsa_delete_node_from_edge();
     int test_hypercsa_insert_node_to_edge();
     int test_hypercsa_insert_edge();
+    int test_hypercsa_delete_node_roundtrip();
+    int test_hypercsa_insert_node_roundtrip();
+    int test_hypercsa_insert_node_shift();
+    int test_hypercsa_find_edge();
+    int test_hypercsa_exact_interval_end();
+    int test_hypercsa_insert_edge_same_position();
+    int test_hypercsa_insert_edge_duplicates();
+    int test_hypercsa_snapshot();
+    int test_hypercsa_delta_delete_prefix();
+    int test_hypercsa_jaccard();
+    int test_hypercsa_dynamic_queries();
+    int test_hypercsa_subset();
+    int test_hypercsa_overlap();
+    int test_hypercsa_boolean();
+    int test_hypercsa_prefix_range();
+    int test_hypercsa_neighbors();
+    int test_hypercsa_degrees();
+    int test_hypercsa_stable_ids();
+    int test_hypercsa_c_api();
+    int test_hypercsa_dynamic_bit_vector();
+    int test_hypercsa_dynamic_sequence();
     int test_query(const char *input_file);
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef __cplusplus // The C++ interface, C callers only see the functions above.
 #include "type_definitions.hpp"
 
 namespace hypercsa {
@@ -33,7 +176,7 @@ namespace hypercsa {
 
     CompressedHyperGraph from_file(const char *input_file);
 
-    int to_file(CompressedHyperGraph hgraph, const char *output_file);
+    int to_file(CompressedHyperGraph &hgraph, const char *output_file);
 
 // Updates
     bool edges_equal(CompressedHyperGraph &graph, Index edge1, Index edge2);
@@ -46,12 +189,19 @@ namespace hypercsa {
 
     int insert_node_to_edge(CompressedHyperGraph &graph, Index pos, Node node);
 
+    // The position of the edge with the stable id for the updates above, -1 if it was deleted. The ids are kept by
+    // all updates, an inserted edge gets graph.next_id - 1.
+    Index edge_position(CompressedHyperGraph &graph, Index id);
+
 // Queries
+    EdgeList query(CompressedHyperGraph &hgraph, Edge query, int type);
+
     //EdgeIterator query(CompressedHyperGraph hgraph, int type, Edge edge);
 
     //Index edge_iterator_next(EdgeIterator ei);
 
     //void edge_iterator_finish(EdgeIterator ei);
 }
+#endif
 
 #endif //HYPERCSA_HYPERCSA_H
@@ -25,7 +25,25 @@ static void print_usage(bool error) {
     "-i [input] -o [output]                    to compress a hypergraph. hypergraph format is one edge per line, nodes are integers and comma separated\n"
     "-i [input] -t [type] -q [list of nodes]   evaluate query on compressed hypergraph. query is a comma-separated-list of integers\n"
     "-i [input] -t [type] -f [queryfile]       evaluates all queries in the file, one query per line.\n"
-    "                                          Type 0 is exists query, Type 1 is contains query.\n"
+    "                                          Type 0 is exists query, Type 1 is contains query,\n"
+    "                                          nodes marked with '!' must not be contained (e.g. 1,2,!7),\n"
+    "                                          Type 2 is subset query (edges with all nodes in the query),\n"
+    "                                          Type 3 is overlap query (edges with at least -m [threshold] query nodes, default 1).\n"
+    "                                          Type 4 is prefix query (edges whose smallest nodes are the query),\n"
+    "                                          Type 5 is range query (edges with all nodes in [a, b], the query is a,b).\n"
+    "-i [input] -t [type] -f [queryfile] -d    compares the static and the dynamic representation on the queries.\n"
+    "-i [input] -t [type] -f [queryfile] -l [text|json]\n"
+    "                                          prints the p50, p90, p99 and p99.9 latency of the queries by query size.\n"
+    "-k [hubs]                                 with -l, -s or -u: contains queries of only the [hubs] nodes with the\n"
+    "                                          highest degree intersect posting lists instead of walking cycles.\n"
+    "-i [input] -a [list of nodes]             inserts the edge. The update is appended to the log [input].log.\n"
+    "-i [input] -r [list of nodes]             deletes the edge. The update is appended to the log [input].log.\n"
+    "-i [input] -c                             checkpoint: folds the log into the compressed hypergraph.\n"
+    "-i [input] -s [-j threads]                server mode: answers queries from stdin on stdout, see read/server.hpp.\n"
+    "-i [input] -u [socket] [-j threads]       server mode on a Unix domain socket.\n"
+    "-i [input] -p                             prints the space breakdown and the degree and cardinality distributions as JSON.\n"
+    "-i [input] -g [list of nodes]             prints the degree (number of edges) of each node.\n"
+    "-i [input] -n [k] [-j threads]            prints the k nodes with the highest degree and their degree.\n"
 
 	;
 	FILE* os = error ? stderr : stdout;
@@ -65,7 +83,20 @@ int main(int argc, char** argv) {
     int type = 0;
     bool mode_compress = false;
     bool mode_read = false;
-    while ((opt = getopt(argc, argv, "hi:o:t:q:f:x")) != -1) {
+    bool compare_dynamic = false;
+    bool checkpoint = false;
+    bool serve = false;
+    bool report = false;
+    std::string latency_format;
+    std::string socket_path;
+    int threads = 0;
+    int hubs = 0;
+    int threshold = 1;
+    std::string degree_nodes;
+    int top_degree_count = -1;
+    std::string insert_edge;
+    std::string delete_edge;
+    while ((opt = getopt(argc, argv, "hi:o:t:q:f:xda:r:csu:j:pl:k:m:g:n:")) != -1) {
         switch (opt) {
             case 'i':
                 input_file = optarg;
@@ -85,7 +116,7 @@ int main(int argc, char** argv) {
             case 't':
                 check_mode(mode_compress, mode_read, false, "t");
                 type = std::stoi(optarg);
-                if (type < 0 || type > 3) {
+                if (type < 0 || type > 5) {
                     printf("Invalid query Type.");
                     return EXIT_FAILURE;
                 }
@@ -102,14 +133,98 @@ int main(int argc, char** argv) {
                     return EXIT_FAILURE;
                 }
                 break;
-            case 'x': // Test mode
+            case 'd':
+                check_mode(mode_compress, mode_read, false, "d");
+                compare_dynamic = true;
+                break;
+            case 'a':
+                check_mode(mode_compress, mode_read, false, "a");
+                insert_edge = optarg;
+                break;
+            case 'r':
+                check_mode(mode_compress, mode_read, false, "r");
+                delete_edge = optarg;
+                break;
+            case 'c':
+                check_mode(mode_compress, mode_read, false, "c");
+                checkpoint = true;
+                break;
+            case 's':
+                check_mode(mode_compress, mode_read, false, "s");
+                serve = true;
+                break;
+            case 'u':
+                check_mode(mode_compress, mode_read, false, "u");
+                serve = true;
+                socket_path = optarg;
+                break;
+            case 'j':
+                threads = std::stoi(optarg);
+                break;
+            case 'k':
+                hubs = std::stoi(optarg);
+                break;
+            case 'm':
+                threshold = std::stoi(optarg);
+                break;
+            case 'g':
+                check_mode(mode_compress, mode_read, false, "g");
+                degree_nodes = optarg;
+                break;
+            case 'n':
+                check_mode(mode_compress, mode_read, false, "n");
+                top_degree_count = std::stoi(optarg);
+                if (top_degree_count < 0) {
+                    printf("Invalid number of nodes.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'p':
+                check_mode(mode_compress, mode_read, false, "p");
+                report = true;
+                break;
+            case 'l':
+                check_mode(mode_compress, mode_read, false, "l");
+                latency_format = optarg;
+                if (latency_format != "text" && latency_format != "json") {
+                    printf("Invalid latency format, use text or json.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'x': // Test mode, fails if one of the checking tests fails.
+            {
                 test_hypercsa_create("/Users/eadler/Documents/projects/hypercsa/test.hcsa");
                 test_hypercsa_delete_edge();
                 test_hypercsa_delete_node_from_edge();
                 test_hypercsa_insert_node_to_edge();
                 test_hypercsa_insert_edge();
+                int failed = 0;
+                failed += test_hypercsa_find_edge() != 0; // The other modify tests look up their edges.
+                failed += test_hypercsa_delete_node_roundtrip() != 0;
+                failed += test_hypercsa_insert_node_roundtrip() != 0;
+                failed += test_hypercsa_insert_node_shift() != 0;
+                failed += test_hypercsa_exact_interval_end() != 0;
+                failed += test_hypercsa_insert_edge_same_position() != 0;
+                failed += test_hypercsa_insert_edge_duplicates() != 0;
+                failed += test_hypercsa_snapshot() != 0;
+                failed += test_hypercsa_delta_delete_prefix() != 0;
+                failed += test_hypercsa_jaccard() != 0;
+                failed += test_hypercsa_dynamic_queries() != 0;
+                failed += test_hypercsa_subset() != 0;
+                failed += test_hypercsa_overlap() != 0;
+                failed += test_hypercsa_boolean() != 0;
+                failed += test_hypercsa_prefix_range() != 0;
+                failed += test_hypercsa_neighbors() != 0;
+                failed += test_hypercsa_degrees() != 0;
+                failed += test_hypercsa_stable_ids() != 0;
+                failed += test_hypercsa_c_api() != 0;
+                failed += test_hypercsa_dynamic_bit_vector() != 0;
+                failed += test_hypercsa_dynamic_sequence() != 0;
                 //test_query("/Users/eadler/Documents/projects/hypercsa/test.hcsa");
-                return 0;
+                if (failed > 0)
+                    printf("%d tests failed.\n", failed);
+                return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
             case 'h':
             default:
                 print_usage(true);
@@ -121,10 +236,30 @@ int main(int argc, char** argv) {
         construct_hypercsa(input_file.c_str(), output_file.c_str());
     }
     if (mode_read) {
-        if (!test_file.empty())
-            query_hypercsa_from_file(input_file.c_str(), type, test_file.c_str());
+        if (!insert_edge.empty() && insert_edge_hypercsa(input_file.c_str(), insert_edge.c_str()) != 0)
+            return EXIT_FAILURE;
+        if (!delete_edge.empty() && delete_edge_hypercsa(input_file.c_str(), delete_edge.c_str()) != 0)
+            return EXIT_FAILURE;
+        if (checkpoint && checkpoint_hypercsa(input_file.c_str()) != 0)
+            return EXIT_FAILURE;
+        if (report && stats_hypercsa(input_file.c_str()) != 0)
+            return EXIT_FAILURE;
+        if (!degree_nodes.empty() && degree_hypercsa(input_file.c_str(), degree_nodes.c_str()) != 0)
+            return EXIT_FAILURE;
+        if (top_degree_count >= 0 && top_degrees_hypercsa(input_file.c_str(), top_degree_count, threads) != 0)
+            return EXIT_FAILURE;
+        if (serve)
+            return serve_hypercsa(input_file.c_str(), socket_path.empty() ? nullptr : socket_path.c_str(), threads, hubs) == 0
+                   ? EXIT_SUCCESS : EXIT_FAILURE;
+        if (!test_file.empty() && !latency_format.empty())
+            return latency_hypercsa_from_file(input_file.c_str(), type, test_file.c_str(), latency_format == "json", hubs) == 0
+                   ? EXIT_SUCCESS : EXIT_FAILURE;
+        if (!test_file.empty() && compare_dynamic)
+            compare_dynamic_hypercsa(input_file.c_str(), type, test_file.c_str());
+        else if (!test_file.empty())
+            query_hypercsa_from_file(input_file.c_str(), type, test_file.c_str(), threshold);
         if (!node_query.empty())
-            query_hypercsa(input_file.c_str(), type, node_query.c_str());
+            query_hypercsa(input_file.c_str(), type, node_query.c_str(), threshold);
     }
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,248 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "delta.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include "compress.hpp"
+
+using namespace std;
+using namespace sdsl;
+
+EdgeKey delta_key(const Edge &edge)
+{
+    EdgeKey key(edge.begin(), edge.end());
+    sort(key.begin(), key.end());
+    return key;
+}
+
+Edge delta_edge(const EdgeKey &key)
+{
+    Edge e(key.size(), 0, 64);
+    copy(key.begin(), key.end(), e.begin());
+    return e;
+}
+
+int64_t delta_pending(DeltaHyperGraph &dgraph, const EdgeKey &key)
+{
+    int64_t count = 0;
+    auto it = dgraph.frozen.find(key);
+    if (it != dgraph.frozen.end())
+        count += it->second;
+    it = dgraph.active.find(key);
+    if (it != dgraph.active.end())
+        count += it->second;
+    return count;
+}
+
+bool delta_matches(const EdgeKey &edge, const EdgeKey &query, int type)
+{
+    switch (type) {
+        case EXACT:
+            return edge == query;
+        case CONTAIN:
+            return includes(edge.begin(), edge.end(), query.begin(), query.end());
+        default: return false;
+    }
+}
+
+// Nodes outside the alphabet of the base cannot be searched in D.
+bool delta_in_base(DeltaHyperGraph &dgraph, const EdgeKey &key)
+{
+    return key.back() < dgraph.base_nodes;
+}
+
+void delta_add(map<EdgeKey, int64_t> &buffer, const EdgeKey &key, int64_t change)
+{
+    int64_t &count = buffer[key];
+    count += change;
+    if (count == 0)
+        buffer.erase(key);
+}
+
+/*
+ * Folds the frozen buffer into a new base and publishes it.
+ * The base is only replaced here and only one compaction runs at a time,
+ * so it can be read without lock while the readers continue on the old base.
+ * The new base is prepared before the lock is taken, so the readers only wait for the swap.
+ */
+int delta_fold(DeltaHyperGraph &dgraph)
+{
+    map<EdgeKey, int64_t> pending;
+    {
+        shared_lock<shared_mutex> lock(dgraph.mutex);
+        pending = dgraph.frozen;
+    }
+
+    HyperGraph graph;
+    for (Edge &e : decompress_all_edges(*dgraph.base))
+    {
+        auto it = pending.find(delta_key(e));
+        if (it != pending.end() && it->second < 0)
+            it->second++; // Tombstone removes this copy.
+        else
+            graph.edges.push_back(e);
+    }
+    for (const auto &[edge, change] : pending)
+    {
+        for (int64_t i = 0; i < change; i++)
+            graph.edges.push_back(delta_edge(edge));
+    }
+    graph.edge_count = graph.edges.size();
+
+    // D requires that every node up to the highest one occurs in an edge.
+    vector<bool> occurs;
+    for (Edge &e : graph.edges)
+    {
+        for (Node node : e)
+        {
+            if (node >= occurs.size())
+                occurs.resize(node + 1, false);
+            occurs[node] = true;
+        }
+    }
+    bool representable = !occurs.empty() && find(occurs.begin(), occurs.end(), false) == occurs.end();
+
+    if (representable)
+    {
+        auto compacted = make_unique<CompressedHyperGraph>(construct(graph));
+        auto prepared = make_unique<PreparedHyperGraph>(*compacted);
+        unique_lock<shared_mutex> lock(dgraph.mutex); // The old base is freed after the lock is released.
+        dgraph.base.swap(compacted);
+        dgraph.prepared.swap(prepared);
+        dgraph.base_nodes = dgraph.prepared->nodes;
+        dgraph.frozen.clear();
+        dgraph.compacting = false;
+        return 0;
+    }
+    else
+    { // Keep the changes buffered until the graph can be represented again.
+        unique_lock<shared_mutex> lock(dgraph.mutex);
+        for (const auto &[edge, change] : dgraph.frozen)
+            delta_add(dgraph.active, edge, change);
+        dgraph.frozen.clear();
+        dgraph.compacting = false;
+        return -1;
+    }
+}
+
+// Requires the exclusive lock.
+void delta_trigger_compaction(DeltaHyperGraph &dgraph)
+{
+    if (dgraph.compacting || dgraph.active.size() < dgraph.compaction_threshold)
+        return;
+    dgraph.compacting = true;
+    if (dgraph.compaction.joinable()) // The last compaction already reset the flag, so it is about to end.
+        dgraph.compaction.join();
+    dgraph.frozen.swap(dgraph.active);
+    dgraph.compaction = thread(delta_fold, ref(dgraph));
+}
+
+int delta_insert_edge(DeltaHyperGraph &dgraph, Edge edge)
+{
+    EdgeKey key = delta_key(edge);
+    if (key.empty())
+        return -1;
+    unique_lock<shared_mutex> lock(dgraph.mutex);
+    delta_add(dgraph.active, key, 1);
+    delta_trigger_compaction(dgraph);
+    return 0;
+}
+
+// Copies of the edge in the base. The exact query also returns some supersets of the query, so the results are
+// compared as whole edges.
+int64_t delta_base_count(DeltaHyperGraph &dgraph, const EdgeKey &key, const Edge &edge)
+{
+    if (!delta_in_base(dgraph, key))
+        return 0;
+    int64_t count = 0;
+    for (Edge &e : query(*dgraph.prepared, edge, EXACT))
+        count += delta_key(e) == key;
+    return count;
+}
+
+int delta_delete_edge(DeltaHyperGraph &dgraph, Edge edge)
+{
+    EdgeKey key = delta_key(edge);
+    if (key.empty())
+        return -1;
+    unique_lock<shared_mutex> lock(dgraph.mutex);
+    int64_t count = delta_pending(dgraph, key) + delta_base_count(dgraph, key, edge);
+    if (count <= 0)
+        return -1; // There is no such edge to delete.
+    delta_add(dgraph.active, key, -1);
+    delta_trigger_compaction(dgraph);
+    return 0;
+}
+
+EdgeList delta_query(DeltaHyperGraph &dgraph, Edge query, int type)
+{
+    EdgeKey key = delta_key(query);
+    EdgeList edge_list;
+    if (key.empty())
+        return edge_list;
+    shared_lock<shared_mutex> lock(dgraph.mutex);
+
+    // Results of the base without the copies hidden by tombstones.
+    if (delta_in_base(dgraph, key))
+    {
+        map<EdgeKey, int64_t> hidden;
+        for (Edge &e : ::query(*dgraph.prepared, query, type))
+        {
+            EdgeKey result = delta_key(e);
+            auto it = hidden.find(result);
+            if (it == hidden.end())
+                it = hidden.emplace(result, -min<int64_t>(delta_pending(dgraph, result), 0)).first;
+            if (it->second > 0)
+                it->second--;
+            else
+                edge_list.push_back(e);
+        }
+    }
+
+    // Inserted edges of both buffers.
+    for (auto *buffer : {&dgraph.frozen, &dgraph.active})
+    {
+        for (const auto &[edge, change] : *buffer)
+        {
+            if (buffer == &dgraph.active && dgraph.frozen.count(edge) > 0)
+                continue; // Already counted with the frozen buffer.
+            if (!delta_matches(edge, key, type))
+                continue;
+            for (int64_t i = 0; i < delta_pending(dgraph, edge); i++)
+                edge_list.push_back(delta_edge(edge));
+        }
+    }
+    return edge_list;
+}
+
+void delta_finish(DeltaHyperGraph &dgraph)
+{
+    thread running;
+    {
+        unique_lock<shared_mutex> lock(dgraph.mutex);
+        running = std::move(dgraph.compaction);
+    }
+    if (running.joinable())
+        running.join();
+}
+
+int delta_compact(DeltaHyperGraph &dgraph)
+{
+    while (true)
+    {
+        delta_finish(dgraph);
+        unique_lock<shared_mutex> lock(dgraph.mutex);
+        if (dgraph.compacting)
+            continue; // A writer started a new compaction in between.
+        if (dgraph.active.empty())
+            return 0;
+        dgraph.compacting = true;
+        dgraph.frozen.swap(dgraph.active);
+        break;
+    }
+    return delta_fold(dgraph);
+}
@@ -0,0 +1,59 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_DELTA_HPP
+#define HYPERCSA_DELTA_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <shared_mutex>
+
+#include "type_definitions.hpp"
+#include "read.hpp"
+
+#define DEFAULT_COMPACTION_THRESHOLD 4096
+
+typedef std::vector<Node> EdgeKey; // Sorted nodes of an edge, used as key in the write buffer.
+
+/*
+ * Write buffer next to a compressed base graph (LSM-style).
+ * Each buffer maps an edge to the change of its multiplicity: positive values are inserted copies,
+ * negative values are tombstones of copies in the base.
+ * The frozen buffer is the one currently folded into a new base by the compaction.
+ * The base is prepared once for the queries, the compaction replaces both together.
+ */
+class DeltaHyperGraph {
+public:
+    std::unique_ptr<CompressedHyperGraph> base;
+    std::unique_ptr<PreparedHyperGraph> prepared;
+    Index base_nodes;
+    std::map<EdgeKey, int64_t> active;
+    std::map<EdgeKey, int64_t> frozen;
+    Index compaction_threshold;
+    bool compacting;
+    std::thread compaction;
+    std::shared_mutex mutex;
+
+    explicit DeltaHyperGraph(CompressedHyperGraph g, Index threshold = DEFAULT_COMPACTION_THRESHOLD)
+            : base(std::make_unique<CompressedHyperGraph>(std::move(g))),
+              prepared(std::make_unique<PreparedHyperGraph>(*base)), compaction_threshold(threshold),
+              compacting(false) {
+        base_nodes = prepared->nodes;
+    }
+
+    ~DeltaHyperGraph() {
+        if (compaction.joinable())
+            compaction.join();
+    }
+};
+
+int delta_insert_edge(DeltaHyperGraph& dgraph, Edge edge);
+int delta_delete_edge(DeltaHyperGraph& dgraph, Edge edge);
+EdgeList delta_query(DeltaHyperGraph& dgraph, Edge query, int type);
+int delta_compact(DeltaHyperGraph& dgraph);
+void delta_finish(DeltaHyperGraph& dgraph);
+
+#endif //HYPERCSA_DELTA_HPP
@@ -0,0 +1,234 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "dynamic.hpp"
+
+#include <algorithm>
+#include <sdsl/enc_vector.hpp>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/rank_support.hpp>
+
+using namespace std;
+using namespace sdsl;
+
+DynamicHyperGraph dynamic_from_static(CompressedHyperGraph &hgraph)
+{
+    rank_support_v<1> rank_d(&hgraph.D);
+    vector<uint64_t> l(hgraph.PSI.size());
+    for (Index i = 0; i < hgraph.PSI.size(); i++)
+        l[hgraph.PSI[i]] = rank_d(i + 1) - 1;
+    return {DynamicBitVector(hgraph.D), DynamicSequence(l)};
+}
+
+CompressedHyperGraph dynamic_to_static(DynamicHyperGraph &dgraph)
+{
+    bit_vector d = dgraph.D.to_bit_vector();
+    // The PSI values of a node are the positions of the node in L in increasing order.
+    vector<Index> next_position;
+    for (Index i = 0; i + 1 < d.size(); i++)
+    {
+        if (d[i])
+            next_position.push_back(i);
+    }
+    int_vector<> psi(dgraph.L.size());
+    for (Index j = 0; j < dgraph.L.size(); j++)
+        psi[next_position[dgraph.L[j]]++] = j;
+    enc_vector<> comp_psi(psi);
+    return {d, comp_psi, edge_starts(psi)};
+}
+
+Node dynamic_node(DynamicHyperGraph &dgraph, Index pos)
+{
+    return dgraph.D.rank1(pos + 1) - 1;
+}
+
+Index dynamic_interval_start(DynamicHyperGraph &dgraph, Node node)
+{
+    return dgraph.D.select1(node + 1);
+}
+
+/*
+ * Compares the cycle at pos with the cycle of the sorted nodes, one symbol more than the edge has.
+ * Returns 1 if the cycle at pos is smaller, -1 if it is larger and 0 if both are the same edge.
+ */
+int dynamic_compare_edge(DynamicHyperGraph &dgraph, Index pos, const vector<Node> &nodes)
+{
+    for (Index j = 0; j <= nodes.size(); j++)
+    {
+        Node current = dynamic_node(dgraph, pos);
+        if (current < nodes[j % nodes.size()])
+            return 1;
+        if (current > nodes[j % nodes.size()])
+            return -1;
+        pos = dgraph.PSI[pos];
+    }
+    return 0;
+}
+
+Index dynamic_find_insert_position_of_first_node(DynamicHyperGraph &dgraph, const vector<Node> &nodes)
+{
+    Index from = dynamic_interval_start(dgraph, nodes[0]);
+    Index to = dynamic_interval_start(dgraph, nodes[0] + 1);
+    while (from < to) {
+        Index middle = from + (to - from) / 2;
+        if (dynamic_compare_edge(dgraph, middle, nodes) == 1)
+            from = middle + 1;
+        else
+            to = middle;
+    }
+    return from;
+}
+
+vector<Node> dynamic_edge_nodes(DynamicHyperGraph &dgraph, Index pos)
+{
+    vector<Node> nodes;
+    Index i = pos;
+    do {
+        nodes.push_back(dynamic_node(dgraph, i));
+        i = dgraph.PSI[i];
+    } while (i != pos);
+    sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+int dynamic_insert_sorted_edge(DynamicHyperGraph &dgraph, const vector<Node> &nodes)
+{
+    Index k = nodes.size();
+    Node sigma = dgraph.D.ones() - 1;
+    Index first_new = k;
+    for (Index j = 0; j < k; j++)
+    {
+        if (nodes[j] >= sigma)
+        {
+            first_new = j;
+            break;
+        }
+    }
+    for (Index j = first_new; j < k; j++)
+    {
+        if (nodes[j] != sigma + (j - first_new))
+            return -1; // A node between would have no position, which D can not represent.
+    }
+
+    // 1. Position of the first node, before anything changes.
+    Index first_position = 0;
+    if (first_new > 0)
+        first_position = dynamic_find_insert_position_of_first_node(dgraph, nodes);
+
+    // 2. New nodes get new intervals of length 1 at the end.
+    for (Index j = first_new; j < k; j++)
+    {
+        dgraph.D.insert(dgraph.D.size(), true); // The old terminal 1 becomes the start of the new node.
+        dgraph.L.insert(dgraph.L.size(), nodes[(j + k - 1) % k]);
+    }
+    if (first_new == 0)
+        return 0;
+
+    // 3. The other nodes backwards: a position is sorted by the position of its successor.
+    // All of these are inserted behind the first position, as their nodes are larger.
+    Index successor = first_new < k ? dgraph.L.size() - (k - first_new) : first_position;
+    for (Index j = first_new - 1; j >= 1; j--)
+    {
+        Index start = dynamic_interval_start(dgraph, nodes[j]);
+        Index position = start + dgraph.L.rank(nodes[j], successor);
+        dgraph.D.insert(start + 1, false);
+        dgraph.L.insert(position, nodes[j - 1]);
+        successor = position;
+    }
+
+    // 4. The first node, which closes the cycle.
+    dgraph.D.insert(dynamic_interval_start(dgraph, nodes[0]) + 1, false);
+    dgraph.L.insert(first_position, nodes[k - 1]);
+    return 0;
+}
+
+int dynamic_insert_edge(DynamicHyperGraph &dgraph, Edge edge)
+{
+    vector<Node> nodes(edge.begin(), edge.end());
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+    if (nodes.empty())
+        return -1;
+    return dynamic_insert_sorted_edge(dgraph, nodes);
+}
+
+Index dynamic_degree(DynamicHyperGraph &dgraph, Node node)
+{
+    return dynamic_interval_start(dgraph, node + 1) - dynamic_interval_start(dgraph, node);
+}
+
+// Only the highest nodes can lose their last position, otherwise D can not represent the gap.
+bool dynamic_can_remove(DynamicHyperGraph &dgraph, vector<Node> nodes)
+{
+    sort(nodes.begin(), nodes.end(), greater<>());
+    Node expected = dgraph.D.ones() - 1;
+    for (Node node : nodes)
+    {
+        if (dynamic_degree(dgraph, node) == 1 && node != --expected)
+            return false;
+    }
+    return true;
+}
+
+int dynamic_delete_edge(DynamicHyperGraph &dgraph, Index pos)
+{
+    // 1. Compute deleted positions
+    vector<Index> positions;
+    Index i = pos;
+    do {
+        positions.push_back(i);
+        i = dgraph.PSI[i];
+    } while (i != pos);
+    sort(positions.begin(), positions.end(), greater<>());
+
+    if (!dynamic_can_remove(dgraph, dynamic_edge_nodes(dgraph, pos)))
+        return -1;
+
+    // 2. Remove from the highest position on, so the lower positions stay valid.
+    for (Index position : positions)
+    {
+        Node node = dynamic_node(dgraph, position);
+        if (dynamic_degree(dgraph, node) == 1)
+            dgraph.D.erase(dgraph.D.size() - 1); // The start of the node becomes the terminal 1.
+        else
+            dgraph.D.erase(dynamic_interval_start(dgraph, node) + 1);
+        dgraph.L.erase(position);
+    }
+    return 0;
+}
+
+// Replaces the edge at pos by the given nodes. The new edge is inserted first, so no node loses all positions in between.
+int dynamic_replace_edge(DynamicHyperGraph &dgraph, Index pos, vector<Node> &nodes)
+{
+    vector<Node> old_nodes = dynamic_edge_nodes(dgraph, pos);
+    vector<Node> removed;
+    set_difference(old_nodes.begin(), old_nodes.end(), nodes.begin(), nodes.end(), back_inserter(removed));
+    if (!dynamic_can_remove(dgraph, removed))
+        return -1;
+    if (!nodes.empty() && dynamic_insert_sorted_edge(dgraph, nodes) != 0)
+        return -1;
+    // pos may have moved, but any copy of the old edge is equal to it.
+    Index old_pos = dynamic_find_insert_position_of_first_node(dgraph, old_nodes);
+    return dynamic_delete_edge(dgraph, old_pos);
+}
+
+int dynamic_delete_node_from_edge(DynamicHyperGraph &dgraph, Index pos, Node node)
+{
+    vector<Node> nodes = dynamic_edge_nodes(dgraph, pos);
+    auto it = find(nodes.begin(), nodes.end(), node);
+    if (it == nodes.end())
+        return 0; // There is no such node to delete.
+    nodes.erase(it);
+    return dynamic_replace_edge(dgraph, pos, nodes);
+}
+
+int dynamic_insert_node_to_edge(DynamicHyperGraph &dgraph, Index pos, Node node)
+{
+    vector<Node> nodes = dynamic_edge_nodes(dgraph, pos);
+    auto it = lower_bound(nodes.begin(), nodes.end(), node);
+    if (it != nodes.end() && *it == node)
+        return 0; // The Node is already in this hyperedge.
+    nodes.insert(it, node);
+    return dynamic_replace_edge(dgraph, pos, nodes);
+}
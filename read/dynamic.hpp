@@ -0,0 +1,21 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_DYNAMIC_HPP
+#define HYPERCSA_DYNAMIC_HPP
+
+#include "type_definitions.hpp"
+
+DynamicHyperGraph dynamic_from_static(CompressedHyperGraph& hgraph);
+CompressedHyperGraph dynamic_to_static(DynamicHyperGraph& dgraph);
+
+int dynamic_delete_edge(DynamicHyperGraph& dgraph, Index pos);
+
+int dynamic_delete_node_from_edge(DynamicHyperGraph& dgraph, Index pos, Node node);
+
+int dynamic_insert_edge(DynamicHyperGraph& dgraph, Edge edge); // A node given twice is inserted once.
+
+int dynamic_insert_node_to_edge(DynamicHyperGraph& dgraph, Index pos, Node node);
+
+#endif //HYPERCSA_DYNAMIC_HPP
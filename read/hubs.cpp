@@ -0,0 +1,119 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "hubs.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace sdsl;
+using namespace std;
+
+HubIndex hub_build(CompressedHyperGraph& graph, CompressedHyperGraph::select_1_type& select_d, Index nodes, uint64_t k,
+                   const EdgeSamples& samples)
+{
+    HubIndex index;
+    k = min(k, nodes);
+    if (k == 0)
+        return index;
+
+    // The k nodes with the largest intervals in D.
+    vector<Node> candidates(nodes);
+    iota(candidates.begin(), candidates.end(), 0);
+    auto degree = [&select_d](Node v) { return select_d(v + 2) - select_d(v + 1); };
+    nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), [&degree](Node a, Node b) {
+        Index da = degree(a), db = degree(b);
+        return da != db ? da > db : a < b;
+    });
+    index.hubs.assign(candidates.begin(), candidates.begin() + k);
+    sort(index.hubs.begin(), index.hubs.end());
+
+    // Each position of a hub is mapped to the backward jump of its edge.
+    vector<Index> list;
+    vector<Index> all_postings;
+    index.offsets = int_vector<>(k + 1, 0);
+    for (uint64_t h = 0; h < k; h++)
+    {
+        list.clear();
+        for (Index p = select_d(index.hubs[h] + 1); p < select_d(index.hubs[h] + 2); p++)
+            list.push_back(edge_start(graph, samples, p));
+        sort(list.begin(), list.end()); // An edge with the hub several times stays several times, as in the interval.
+        all_postings.insert(all_postings.end(), list.begin(), list.end());
+        index.offsets[h + 1] = all_postings.size();
+    }
+    index.postings = int_vector<>(all_postings.size(), 0);
+    copy(all_postings.begin(), all_postings.end(), index.postings.begin());
+    util::bit_compress(index.postings);
+    util::bit_compress(index.offsets);
+    return index;
+}
+
+// Smallest position in [from, to) with postings[position] >= value, by galloping from from.
+Index hub_seek(const HubIndex& index, Index from, Index to, Index value, uint64_t& postings_read)
+{
+    Index step = 1, low = from, high = from;
+    while (high < to && index.postings[high] < value)
+    {
+        postings_read++;
+        low = high + 1;
+        high = min(to, high + step);
+        step *= 2;
+    }
+    while (low < high)
+    {
+        Index middle = low + (high - low) / 2;
+        postings_read++;
+        if (index.postings[middle] < value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+bool hub_contains(const HubIndex& index, const Edge& query, vector<Index>& positions, uint64_t& postings_read)
+{
+    positions.clear();
+    if (index.empty() || query.size() == 0)
+        return false;
+    vector<pair<Index, Index>> lists; // [from, to) in postings, one per distinct query node.
+    vector<Node> nodes(query.begin(), query.end());
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+    if (nodes.size() != query.size())
+        return false; // Repeated query nodes are left to the cycle walk.
+    for (Node v : nodes)
+    {
+        auto it = lower_bound(index.hubs.begin(), index.hubs.end(), v);
+        if (it == index.hubs.end() || *it != v)
+            return false;
+        size_t h = it - index.hubs.begin();
+        lists.emplace_back(index.offsets[h], index.offsets[h + 1]);
+    }
+    // The shortest list is the smallest interval, so the results repeat like the cycle walk from that interval.
+    stable_sort(lists.begin(), lists.end(), [](const pair<Index, Index>& a, const pair<Index, Index>& b) {
+        return a.second - a.first < b.second - b.first;
+    });
+
+    // Leapfrog over the shortest list, the others seek forward.
+    vector<Index> cursors(lists.size());
+    for (size_t l = 0; l < lists.size(); l++)
+        cursors[l] = lists[l].first;
+    for (Index i = lists[0].first; i < lists[0].second; i++)
+    {
+        Index candidate = index.postings[i];
+        postings_read++;
+        bool in_all = true;
+        for (size_t l = 1; l < lists.size() && in_all; l++)
+        {
+            cursors[l] = hub_seek(index, cursors[l], lists[l].second, candidate, postings_read);
+            if (cursors[l] == lists[l].second)
+                return true; // A list is exhausted, no further results.
+            in_all = index.postings[cursors[l]] == candidate;
+        }
+        if (in_all)
+            positions.push_back(candidate);
+    }
+    return true;
+}
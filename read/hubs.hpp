@@ -0,0 +1,38 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_HUBS_HPP
+#define HYPERCSA_HUBS_HPP
+
+#include <vector>
+
+#include "type_definitions.hpp"
+#include "samples.hpp"
+
+#define HUB_DEFAULT_COUNT 64
+
+/*
+ * Posting lists of the nodes with the highest degree (hubs).
+ * An edge is identified by its backward jump in PSI (the position of its largest node), so the list of a hub holds
+ * the backward jumps of all edges that contain it, sorted and bit-compressed. A contains query of only hubs is then
+ * answered by intersecting the lists, instead of walking every cycle of the smallest interval.
+ * The index belongs to one version of the graph and has to be rebuilt after a modification.
+ */
+class HubIndex {
+public:
+    std::vector<Node> hubs; // Sorted.
+    sdsl::int_vector<> offsets; // The list of hubs[i] is postings[offsets[i]] to postings[offsets[i+1]-1].
+    sdsl::int_vector<> postings;
+
+    bool empty() const { return hubs.empty(); }
+};
+
+// Builds the lists of the k nodes with the highest degree, nodes is the number of nodes in D. The samples may be empty.
+HubIndex hub_build(CompressedHyperGraph& graph, CompressedHyperGraph::select_1_type& select_d, Index nodes, uint64_t k,
+                   const EdgeSamples& samples);
+// Returns false if a query node is no hub. Otherwise, writes the backward jumps of all edges that contain the
+// (distinct) query nodes to positions, sorted, and adds the number of read postings.
+bool hub_contains(const HubIndex& index, const Edge& query, std::vector<Index>& positions, uint64_t& postings_read);
+
+#endif //HYPERCSA_HUBS_HPP
@@ -3,14 +3,105 @@
 //
 
 #include "modify.hpp"
+#include <algorithm>
 #include <sdsl/enc_vector.hpp>
 #include <sdsl/int_vector.hpp>
 
 using namespace std;
 using namespace sdsl;
 
-int modify_delete_edge(CompressedHyperGraph &hgraph, Index pos)
+// Rank in E of the edge with the position, i.e. the index of its stable id.
+Index modify_edge_rank(const CompressedHyperGraph &hgraph, Index pos)
+{
+    while (!hgraph.E[pos])
+        pos = hgraph.PSI[pos];
+    rank_support_v<1> rank_e(&hgraph.E);
+    return rank_e.rank(pos);
+}
+
+/*
+ * Moves the entry old_rank of an array over the edges of E to new_rank with the value. An old_rank of -1 inserts the
+ * value, a new_rank of -1 deletes the entry.
+ */
+int_vector<> modify_move_rank(const int_vector<> &values, Index old_rank, Index new_rank, uint64_t value)
+{
+    int_vector<> moved(values.size() + (old_rank == (Index) -1) - (new_rank == (Index) -1), 0);
+    Index i_moved = 0;
+    for (Index i_values = 0; i_values <= values.size(); i_values++)
+    {
+        if (i_moved == new_rank)
+            moved[i_moved++] = value;
+        if (i_values < values.size() && i_values != old_rank)
+            moved[i_moved++] = values[i_values];
+    }
+    util::bit_compress(moved);
+    return moved;
+}
+
+/*
+ * Updates the stable ids and their ranks after the edge with the rank old_rank changed, or was deleted if pos is -1.
+ * The edges that did not change keep their order in E, so only the entries of the changed edge move, to the rank of
+ * the backward jump reached from pos in the new E. old_rank is -1 for a new edge, which gets next_id. Only the ids
+ * between the old and the new rank change their rank, the rank of a deleted id is left stale (see edge_id_rank).
+ */
+void modify_update_edges(const CompressedHyperGraph &hgraph, CompressedHyperGraph &target, const int_vector<> &new_psi,
+                         Index old_rank, Index pos)
+{
+    Index new_rank = -1;
+    if (pos != (Index) -1)
+    {
+        while (new_psi[pos] > pos)
+            pos = new_psi[pos];
+        rank_support_v<1> rank_e(&target.E);
+        new_rank = rank_e.rank(pos);
+    }
+
+    uint64_t next_id = hgraph.next_id;
+    Index id = old_rank != (Index) -1 ? hgraph.ids[old_rank] : next_id++;
+    int_vector<> ids = modify_move_rank(hgraph.ids, old_rank, new_rank, id);
+    int_vector<> id_ranks;
+    if (hgraph.id_ranks.width() < 64 && (ids.size() >> hgraph.id_ranks.width()) > 0) // The new ranks do not fit.
+    {
+        id_ranks = int_vector<>(next_id, 0, hgraph.id_ranks.width() + 1);
+        for (Index i = 0; i < hgraph.id_ranks.size(); i++)
+            id_ranks[i] = hgraph.id_ranks[i];
+    }
+    else
+    {
+        id_ranks = hgraph.id_ranks;
+        id_ranks.resize(next_id);
+    }
+    Index from = min(old_rank, new_rank); // -1 is the largest Index.
+    Index to = old_rank != (Index) -1 && new_rank != (Index) -1 ? max(old_rank, new_rank) + 1 : ids.size();
+    for (Index rank = from; rank < to; rank++)
+        id_ranks[ids[rank]] = rank;
+
+    target.ids = std::move(ids);
+    target.next_id = next_id;
+    target.id_ranks = std::move(id_ranks);
+}
+
+// The modification keeps the graph as it is, so the target gets a copy unless it is the graph itself.
+int modify_unchanged(const CompressedHyperGraph &hgraph, CompressedHyperGraph &target)
 {
+    if (&target != &hgraph)
+        target = hgraph;
+    return 0;
+}
+
+Index modify_find_id(const CompressedHyperGraph &hgraph, Index id)
+{
+    Index rank = edge_id_rank(hgraph, id);
+    if (rank == (Index) -1)
+        return -1;
+    select_support_mcl<1> select_e(&hgraph.E); // Built over the words of E, instead of a scan over its bits.
+    return select_e.select(rank + 1);
+}
+
+int modify_delete_edge(const CompressedHyperGraph &hgraph, CompressedHyperGraph &target, Index pos)
+{
+    Index old_rank = modify_edge_rank(hgraph, pos);
+
     // 1. Compute deleted positions
     bit_vector deletes(hgraph.D.size(), 0);
     Index i_deletes = pos;
@@ -59,136 +150,159 @@ int modify_delete_edge(CompressedHyperGraph &hgraph, Index pos)
         }
     }
 
-    // 4. Override old arrays.
+    // 4. Write the new arrays to the target.
     enc_vector<> comp_psi(new_psi);
-    hgraph.D = std::move(new_d);
-    hgraph.PSI = std::move(comp_psi);
+    target.D = std::move(new_d);
+    target.PSI = std::move(comp_psi);
+    target.E = edge_starts(new_psi);
+    modify_update_edges(hgraph, target, new_psi, old_rank, -1);
     return 0;
 }
 
-void modify_intervals_downward_sort(int_vector<> &new_psi, bit_vector &new_d, Index pos)
+int modify_delete_edge(CompressedHyperGraph &hgraph, Index pos)
 {
-    rank_support_v<1> rank_new_d(&new_d);
-    select_support_mcl<1> select_new_d(&new_d);
-    bool changed = true;
-    Index changed_pos = pos;
-    // while (new_psi[changed_pos] != pos) // The old position is 1 smaller than the current started.
-    //    changed_pos = new_psi[changed_pos];
+    return modify_delete_edge(hgraph, hgraph, pos);
+}
 
-    while (changed)
+/*
+ * Node of the entry that jumps to each position, the L of DynamicHyperGraph. It needs the bits of a node instead of a
+ * position, unlike a full inverse of PSI.
+ */
+int_vector<> modify_jump_nodes(const int_vector<> &psi, const bit_vector &d, Node nodes)
+{
+    uint8_t width = 1;
+    while (width < 64 && (nodes >> width) > 0)
+        width++;
+    int_vector<> L(psi.size(), 0, width);
+    Node node = -1;
+    for (Index i = 0; i < psi.size(); i++)
     {
-        changed = false;
-        Node next_node = rank_new_d.rank(changed_pos)-1;
-        Index interval_start = select_new_d.select(next_node+1);
-        // Index interval_end = select_new_d.select(next_node+2);
+        if (d[i] == 1)
+            node++;
+        L[psi[i]] = node;
+    }
+    return L;
+}
 
-        // Is resorting necessary?
-        Index switch_position = changed_pos;
-        while (switch_position-1 >= interval_start && new_psi[switch_position-1] > new_psi[switch_position])
-        {
-            switch_position--;
-        }
-        if (switch_position != changed_pos) //The actual check.
-            changed = true;
+/*
+ * Inverse of PSI like DynamicHyperGraph::lf. The entry that jumps to j is in the interval of L[j], which is sorted
+ * apart from the entry at unsorted, so it is found by a binary search that skips that entry.
+ */
+Index modify_lf(const int_vector<> &psi, const int_vector<> &L, select_support_mcl<1> &select_d, Index j, Index unsorted)
+{
+    if (psi[unsorted] == j)
+        return unsorted;
+    Index from = select_d.select(L[j] + 1);
+    Index to = select_d.select(L[j] + 2);
+    bool skip = from <= unsorted && unsorted < to;
+    auto position = [&](Index k) -> Index {
+        return skip && from + k >= unsorted ? from + k + 1 : from + k;
+    };
+    Index low = 0, high = to - from - skip;
+    while (low < high)
+    {
+        Index middle = low + (high - low) / 2;
+        if (psi[position(middle)] < j)
+            low = middle + 1;
         else
-            break;
-
-        // Resort interval
-        Index help = new_psi[changed_pos];
-        for (Index new_pos = changed_pos; new_pos > switch_position; new_pos--)
-            new_psi[new_pos] = new_psi[new_pos - 1];
-        new_psi[switch_position] = help;
+            high = middle;
+    }
+    return position(low);
+}
 
-        // fix jumps of moved nodes.
-        for (Index update_position = switch_position+1; update_position <= changed_pos; update_position++)
-        {
-            Index edge_help_pos = update_position; // Find the positions that point to the old position.
-            while (new_psi[edge_help_pos] != update_position-1) // The old position is 1 smaller than the current started.
-                edge_help_pos = new_psi[edge_help_pos];
-            new_psi[edge_help_pos]++; // Node is moved just one position up.
-        }
+/*
+ * Moves the entry at position from to position to and shifts the entries in between by one.
+ * The jumps to all moved entries are redirected with the LF of each entry instead of walking their cycles.
+ * Returns the new position of the entry that jumps to the moved entry.
+ */
+Index modify_move_entry(int_vector<> &psi, int_vector<> &L, select_support_mcl<1> &select_d, Index from, Index to)
+{
+    Index low = min(from, to), high = max(from, to);
+    auto moved = [&](Index p) -> Index {
+        if (p < low || p > high)
+            return p;
+        if (p == from)
+            return to;
+        return from < to ? p - 1 : p + 1;
+    };
+
+    // Remember the jumps to the range before the entries move. Only the entry at from is out of order.
+    vector<Index> predecessors(high - low + 1);
+    vector<Node> nodes(high - low + 1);
+    for (Index p = low; p <= high; p++)
+    {
+        predecessors[p - low] = modify_lf(psi, L, select_d, p, from);
+        nodes[p - low] = L[p];
+    }
 
-        // fix and set the changed edge
-        Index edge_help_pos = switch_position; // Find the positions that point to the old position.
-        while (new_psi[edge_help_pos] != changed_pos) // The old position is 1 smaller than the current started.
-            edge_help_pos = new_psi[edge_help_pos];
-        new_psi[edge_help_pos] = switch_position; // Node is moved just one position up.
+    // Move the entry.
+    Index help = psi[from];
+    if (from < to)
+        for (Index p = from; p < to; p++)
+            psi[p] = psi[p + 1];
+    else
+        for (Index p = from; p > to; p--)
+            psi[p] = psi[p - 1];
+    psi[to] = help;
 
-        changed_pos = edge_help_pos; // define next iterations update position.
+    // Redirect the jumps to the moved entries. The moved entries keep their predecessors and with them their nodes in L.
+    for (Index p = low; p <= high; p++)
+    {
+        psi[moved(predecessors[p - low])] = moved(p);
+        L[moved(p)] = nodes[p - low];
     }
+    return moved(predecessors[from - low]);
 }
 
-void modify_intervals_upward_sort(int_vector<> &new_psi, bit_vector &new_d, Index pos)
+/*
+ * Restores the order of PSI within the intervals of D after the jump at pos changed.
+ * Moving an entry changes the jump to it, so the entry that jumps to it is sorted next, until an entry stays.
+ * Returns the position of the entry that stayed, which belongs to the same edge as pos.
+ */
+Index modify_intervals_sort(int_vector<> &new_psi, bit_vector &new_d, Index pos)
 {
     rank_support_v<1> rank_new_d(&new_d);
     select_support_mcl<1> select_new_d(&new_d);
-    bool changed = true;
+    int_vector<> L = modify_jump_nodes(new_psi, new_d, rank_new_d.rank(new_d.size()) - 1);
     Index changed_pos = pos;
-    // while (new_psi[changed_pos] != pos) // The old position is 1 smaller than the current started.
-    //    changed_pos = new_psi[changed_pos];
 
-    while (changed)
+    while (true)
     {
-        changed = false;
-        Node next_node = rank_new_d.rank(changed_pos)-1;
-        // Index interval_start = select_new_d.select(next_node + 1);
-        Index interval_end = select_new_d.select(next_node + 2);
+        Node node = rank_new_d.rank(changed_pos + 1) - 1;
+        Index interval_start = select_new_d.select(node + 1);
+        Index interval_end = select_new_d.select(node + 2);
 
         // Is resorting necessary?
         Index switch_position = changed_pos;
-        while (switch_position + 1 < interval_end && new_psi[switch_position] > new_psi[switch_position + 1])
-        {
-            switch_position++;
-        }
-        if (switch_position != changed_pos) //The actual check.
-            changed = true;
-        else
+        while (switch_position > interval_start && new_psi[switch_position - 1] > new_psi[changed_pos])
+            switch_position--;
+        if (switch_position == changed_pos)
+            while (switch_position + 1 < interval_end && new_psi[switch_position + 1] < new_psi[changed_pos])
+                switch_position++;
+        if (switch_position == changed_pos)
             break;
 
-        // Resort interval
-        Index help = new_psi[changed_pos];
-        for (Index new_pos = changed_pos; new_pos < switch_position; new_pos++)
-            new_psi[new_pos] = new_psi[new_pos + 1];
-        new_psi[switch_position] = help;
-
-        // fix jumps of moved nodes.
-        for (Index update_position = changed_pos; update_position < switch_position; update_position++)
-        {
-            Index edge_help_pos = update_position; // Find the positions that point to the old position.
-            while (new_psi[edge_help_pos] != update_position+1) // The old position is 1 greater than the current started.
-                edge_help_pos = new_psi[edge_help_pos];
-            new_psi[edge_help_pos]--; // Node is moved just one position down.
-        }
-
-        // fix and set the changed edge
-        Index edge_help_pos = switch_position; // Find the positions that point to the old position.
-        while (new_psi[edge_help_pos] != changed_pos) // The old position is changed_pos.
-            edge_help_pos = new_psi[edge_help_pos];
-        new_psi[edge_help_pos] = switch_position;
-
-        changed_pos = edge_help_pos; // define next iterations update position.
+        changed_pos = modify_move_entry(new_psi, L, select_new_d, changed_pos, switch_position);
     }
+    return changed_pos;
 }
 
-int modify_delete_node_from_edge(CompressedHyperGraph &hgraph, Index pos, Node node)
+int modify_delete_node_from_edge(const CompressedHyperGraph &hgraph, CompressedHyperGraph &target, Index pos, Node node)
 {
-    // 1. Compute deleted positions
-    Index i_deletes = pos;
+    // 1. Compute deleted position and the position jumping to it.
     rank_support_v<1> rank_d(&hgraph.D);
-    Index pos_delete = -1;
-
-    while (hgraph.PSI[i_deletes] != pos)
+    Index pos_prev = pos;
+    Index pos_delete = hgraph.PSI[pos];
+    while (rank_d.rank(pos_delete+1)-1 != node)
     {
-        i_deletes = hgraph.PSI[i_deletes];
-        Node current = rank_d.rank(i_deletes)-1;
-        if (current == node)
-        {
-            pos_delete = i_deletes;
-            break;
-        }
+        if (pos_delete == pos)
+            return modify_unchanged(hgraph, target); // There is no such node to delete.
+        pos_prev = pos_delete;
+        pos_delete = hgraph.PSI[pos_delete];
     }
-    if (pos_delete == -1)
-        return 0; // There is no such node to delete.
+    if (pos_prev == pos_delete)
+        return modify_delete_edge(hgraph, target, pos); // The node is the only one of the edge.
+    Index old_rank = modify_edge_rank(hgraph, pos);
 
     // 2. Compute updated D
     bit_vector new_d(hgraph.D.size() - 1, 0);
@@ -214,47 +328,34 @@ int modify_delete_node_from_edge(CompressedHyperGraph &hgraph, Index pos, Node n
     // 3. Compute updated PSI
     int_vector<> new_psi(hgraph.PSI.size() - 1);
     Index i_new_psi = 0;
-    bool replaced_last_node = false;
-    Index pos_jump_changed = -1;
     for (Index i_old_psi = 0; i_old_psi < hgraph.PSI.size(); i_old_psi++)
     {
         if (i_old_psi != pos_delete)
         {
-            // In decreasing order of chance of occurrence
-            if (hgraph.PSI[i_old_psi] < pos_delete)
-                new_psi[i_new_psi] = hgraph.PSI[i_old_psi];
-            else if (hgraph.PSI[i_old_psi] > pos_delete)
-                new_psi[i_new_psi] = hgraph.PSI[i_old_psi] - 1;
-            else if (hgraph.PSI[hgraph.PSI[i_old_psi]] > pos_delete)
-            {
-                new_psi[i_new_psi] = hgraph.PSI[hgraph.PSI[i_old_psi]] - 1; // Skip Jump
-                pos_jump_changed = i_new_psi;
-            }
-            else
-            { // The last node of an edge was deleted -> new L-Type position.
-                new_psi[i_new_psi] = hgraph.PSI[hgraph.PSI[i_old_psi]]; // Skip Jump
-                replaced_last_node = true;
-                pos_jump_changed = i_new_psi;
-            }
+            Index next = i_old_psi != pos_prev ? hgraph.PSI[i_old_psi] : hgraph.PSI[pos_delete]; // Skip Jump
+            new_psi[i_new_psi] = next < pos_delete ? next : next - 1;
             i_new_psi++;
         }
     }
 
     // 4. Fix intervals.
-    if (!replaced_last_node)
-        modify_intervals_upward_sort(new_psi, new_d, pos_jump_changed);
-    else
-        modify_intervals_downward_sort(new_psi, new_d, pos_jump_changed);
-
+    Index edge_pos = modify_intervals_sort(new_psi, new_d, pos_prev < pos_delete ? pos_prev : pos_prev - 1);
 
-    // 5. Override old arrays.
+    // 5. Write the new arrays to the target.
     enc_vector<> comp_psi(new_psi);
-    hgraph.D = std::move(new_d);
-    hgraph.PSI = std::move(comp_psi);
+    target.D = std::move(new_d);
+    target.PSI = std::move(comp_psi);
+    target.E = edge_starts(new_psi);
+    modify_update_edges(hgraph, target, new_psi, old_rank, edge_pos);
     return 0;
 }
 
-Index modify_search_insert_position(enc_vector<> &PSI, Index from, Index to, Index next_position)
+int modify_delete_node_from_edge(CompressedHyperGraph &hgraph, Index pos, Node node)
+{
+    return modify_delete_node_from_edge(hgraph, hgraph, pos, node);
+}
+
+Index modify_search_insert_position(const enc_vector<> &PSI, Index from, Index to, Index next_position)
 {
     // Solution inspired by ChatGPT
     // Finding `low` (smallest index where psi[low] >= next_from)
@@ -265,28 +366,41 @@ Index modify_search_insert_position(enc_vector<> &PSI, Index from, Index to, Ind
     return std::distance(PSI.begin(), low_it);
 }
 
-int modify_insert_node_to_edge(CompressedHyperGraph &hgraph, Index pos, Node node)
+int modify_insert_node_to_edge(const CompressedHyperGraph &hgraph, CompressedHyperGraph &target, Index pos, Node node)
 {
     // 1. Compute Insert-Positions
     rank_support_v<1> rank_d(&hgraph.D);
     select_support_mcl<1> select_d(&hgraph.D);
+    if (node + 1 >= rank_d.rank(hgraph.D.size()))
+        return -1; // D can only represent nodes that already have an interval.
+    // The node is inserted behind the largest smaller node, or behind the largest node if there is no smaller one.
     Index i_prev = pos;
-    Node node_prev;
-    Index i_after = hgraph.PSI[i_prev];
-    Node node_after = rank_d.rank(i_after)-1;
-    while (i_after != pos // should never happen. Aborts if the full cycle is iterated.
-        && !(node_prev < node && node < node_after) // the node is in between,
-        && !(i_prev > i_after && (node_prev < node || node < node_after))) // the node is greater than all || the node is lower than all
-    {
-        i_prev = i_after;
-        node_prev = node_after;
-        i_after = hgraph.PSI[i_after];
-        node_after = rank_d.rank(i_after)-1;
-        if (node_after == node)
+    Node node_prev = rank_d.rank(pos+1)-1;
+    Index i_max = pos;
+    Node node_max = node_prev;
+    bool found_smaller = node_prev < node;
+    Index i = pos;
+    do {
+        Node current = rank_d.rank(i+1)-1;
+        if (current == node)
+            return modify_unchanged(hgraph, target); // The Node is already in this hyperedge.
+        if (current > node_max)
         {
-            return 0; // The Node is already in this hyperedge.
+            i_max = i;
+            node_max = current;
         }
-    }
+        if (current < node && (!found_smaller || current > node_prev))
+        {
+            i_prev = i;
+            node_prev = current;
+            found_smaller = true;
+        }
+        i = hgraph.PSI[i];
+    } while (i != pos);
+    if (!found_smaller)
+        i_prev = i_max;
+    Index i_after = hgraph.PSI[i_prev];
+    Index old_rank = modify_edge_rank(hgraph, i_max);
     Index insert_position = modify_search_insert_position(
             hgraph.PSI,
             select_d.select(node+1),
@@ -327,42 +441,46 @@ int modify_insert_node_to_edge(CompressedHyperGraph &hgraph, Index pos, Node nod
         i_new_psi++;
 
     }
-    new_psi[i_prev] = insert_position;
-    new_psi[insert_position] = i_after;
+    Index i_prev_new = i_prev < insert_position ? i_prev : i_prev + 1;
+    new_psi[i_prev_new] = insert_position;
+    new_psi[insert_position] = i_after < insert_position ? i_after : i_after + 1;
 
+    // 4. Fix intervals. The new position is sorted already, but the jump to it changed.
+    Index edge_pos = modify_intervals_sort(new_psi, new_d, i_prev_new);
 
-    // 4. Fix intervals. TODO: correct?
-    if (new_psi[insert_position] < insert_position) // If new node is the new highest node of the edge.
-        modify_intervals_upward_sort(new_psi, new_d, i_prev);
-    else
-        modify_intervals_downward_sort(new_psi, new_d, i_prev);
-
-    // 5. Override old arrays.
+    // 5. Write the new arrays to the target.
     enc_vector<> comp_psi(new_psi);
-    hgraph.D = std::move(new_d);
-    hgraph.PSI = std::move(comp_psi);
+    target.D = std::move(new_d);
+    target.PSI = std::move(comp_psi);
+    target.E = edge_starts(new_psi);
+    modify_update_edges(hgraph, target, new_psi, old_rank, edge_pos);
     return 0;
 }
 
-int modify_compare_edge(CompressedHyperGraph &hgraph, Index pos, Edge &edge, rank_support_v<> &rank_d)
+int modify_insert_node_to_edge(CompressedHyperGraph &hgraph, Index pos, Node node)
+{
+    return modify_insert_node_to_edge(hgraph, hgraph, pos, node);
+}
+
+/*
+ * Compares the cycle at pos with the cycle of the sorted edge, one node more than the edge has.
+ * Returns 1 if the cycle at pos is smaller, -1 if it is larger and 0 if both are the same edge.
+ */
+int modify_compare_edge(const CompressedHyperGraph &hgraph, Index pos, Edge &edge, rank_support_v<> &rank_d)
 {
-    pos = hgraph.PSI[pos];
-    for (Index i_rank = 1; i_rank < edge.size(); i_rank++)
+    for (Index i_rank = 0; i_rank <= edge.size(); i_rank++)
     {
-        Node current = rank_d.rank(pos)-1;
-        if (current == edge[i_rank])
-        {}
-        else if (current < edge[i_rank])
+        Node current = rank_d.rank(pos+1)-1;
+        if (current < edge[i_rank % edge.size()])
             return 1;
-        else return -1;
+        if (current > edge[i_rank % edge.size()])
+            return -1;
+        pos = hgraph.PSI[pos];
     }
-    if (hgraph.PSI[pos] < pos)
-        return 0; // It also is L-Type -> the suffixes are equal.
-    else
-        return -1; // The edge in the structure contains more nodes -> it is larger.
+    return 0;
 }
 
-Index modify_find_insert_position_of_first_node(CompressedHyperGraph &hgraph, Edge &edge, Index from, Index to, rank_support_v<> &rank_d)
+Index modify_find_insert_position_of_first_node(const CompressedHyperGraph &hgraph, Edge &edge, Index from, Index to, rank_support_v<> &rank_d)
 {
     Index middle = from;
     while (from < to) {
@@ -378,31 +496,46 @@ Index modify_find_insert_position_of_first_node(CompressedHyperGraph &hgraph, Ed
     return from;
 }
 
-int modify_insert_edge(CompressedHyperGraph &hgraph, Edge edge)
+Index modify_find_edge(const CompressedHyperGraph &hgraph, Edge edge)
 {
-    // 1. Find positions.
     rank_support_v<1> rank_d(&hgraph.D);
     select_support_mcl<1> select_d(&hgraph.D);
+    sort(edge.begin(), edge.end());
+    if (edge.size() == 0 || edge[edge.size()-1] + 1 >= rank_d.rank(hgraph.D.size()))
+        return -1;
     Index from = select_d.select(edge[0]+1);
     Index to = select_d.select(edge[0]+2);
-    Index insert_position = modify_find_insert_position_of_first_node(hgraph, edge, from, to, rank_d);
+    Index pos = modify_find_insert_position_of_first_node(hgraph, edge, from, to, rank_d);
+    if (pos < to && modify_compare_edge(hgraph, pos, edge, rank_d) == 0)
+        return pos;
+    return -1; // There is no such edge.
+}
 
-    bit_vector inserts(hgraph.D.size(), 0);
-    inserts[insert_position] = true;
-#ifdef VERBOSE_DEBUG
-    cout << "Insert Positions: " << insert_position;
-#endif
+int modify_insert_edge(const CompressedHyperGraph &hgraph, CompressedHyperGraph &target, Edge edge)
+{
+    // 1. Find positions. Two nodes can be inserted before the same old position, so all positions are kept in node order.
+    rank_support_v<1> rank_d(&hgraph.D);
+    select_support_mcl<1> select_d(&hgraph.D);
+    sort(edge.begin(), edge.end());
+    edge.resize(unique(edge.begin(), edge.end()) - edge.begin()); // A node is inserted once, like dynamic_insert_edge.
+    if (edge.size() == 0 || edge[edge.size()-1] + 1 >= rank_d.rank(hgraph.D.size()))
+        return -1; // D can only represent nodes that already have an interval.
+    vector<Index> inserts(edge.size());
+    Index from = select_d.select(edge[0]+1);
+    Index to = select_d.select(edge[0]+2);
+    inserts[0] = modify_find_insert_position_of_first_node(hgraph, edge, from, to, rank_d);
+    Index insert_position = inserts[0];
     for (Index i_rank = edge.size()-1; i_rank > 0; i_rank--)
     {
         from = select_d.select(edge[i_rank]+1);
         to = select_d.select(edge[i_rank]+2);
         insert_position = modify_search_insert_position(hgraph.PSI, from, to, insert_position);
-        inserts[insert_position] = true;
-#ifdef VERBOSE_DEBUG
-        cout << " %llu" << insert_position;
-#endif
+        inserts[i_rank] = insert_position;
     }
 #ifdef VERBOSE_DEBUG
+    cout << "Insert Positions:";
+    for (Index i_rank = 0; i_rank < edge.size(); i_rank++)
+        cout << " " << inserts[i_rank];
     cout << "\n";
 #endif
 
@@ -426,34 +559,38 @@ int modify_insert_edge(CompressedHyperGraph &hgraph, Edge edge)
         }
     }
 
-    // 3. Compute updated PSI
-    rank_support_v<1> rank_inserts(&inserts);
+    // 3. Compute updated PSI. An old position moves behind all new positions inserted before or at it.
     int_vector<> new_psi(hgraph.PSI.size() + edge.size());
     Index i_new_psi = 0;
+    Index i_inserts = 0;
     for (Index i_old_psi = 0; i_old_psi < hgraph.PSI.size(); i_old_psi++)
     {
-        if (inserts[i_old_psi] == 1) // skip the positions of the new edge.
+        while (i_inserts < edge.size() && inserts[i_inserts] == i_old_psi) // skip the positions of the new edge.
+        {
+            i_inserts++;
             i_new_psi++;
-        new_psi[i_new_psi] = hgraph.PSI[i_old_psi] + rank_inserts.rank(hgraph.PSI[i_old_psi]+1);
+        }
+        Index next = hgraph.PSI[i_old_psi];
+        new_psi[i_new_psi] = next + (upper_bound(inserts.begin(), inserts.end(), next) - inserts.begin());
         i_new_psi++;
     }
-    // Set the jumps of the new edge.
-    select_support_mcl<1> select_inserts(&inserts);
-    Index last_pos = select_inserts.select(edge.size()) + edge.size() - 1; // set the downward jump first.
-    Index next_pos = select_inserts.select(1);
-    assert(new_psi[last_pos] == 0);
-    new_psi[last_pos] = next_pos;
-    for (Index i_rank = 1; i_rank < edge.size(); i_rank++)
+    // Set the jumps of the new edge. The i-th new position is shifted by the i new positions before it.
+    for (Index i_rank = 0; i_rank < edge.size(); i_rank++)
     {
-        last_pos = next_pos;
-        next_pos = select_inserts.select(i_rank+1) + i_rank;
-        assert(new_psi[last_pos] == 0);
-        new_psi[last_pos] = next_pos;
+        Index i_next = (i_rank + 1) % edge.size();
+        new_psi[inserts[i_rank] + i_rank] = inserts[i_next] + i_next;
     }
 
-    // 4. Override old arrays.
+    // 4. Write the new arrays to the target.
     enc_vector<> comp_psi(new_psi);
-    hgraph.D = std::move(new_d);
-    hgraph.PSI = std::move(comp_psi);
+    target.D = std::move(new_d);
+    target.PSI = std::move(comp_psi);
+    target.E = edge_starts(new_psi);
+    modify_update_edges(hgraph, target, new_psi, -1, inserts[0]);
     return 0;
-}
\ No newline at end of file
+}
+
+int modify_insert_edge(CompressedHyperGraph &hgraph, Edge edge)
+{
+    return modify_insert_edge(hgraph, hgraph, edge);
+}
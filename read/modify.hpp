@@ -5,12 +5,29 @@
 #ifndef HYPERCSA_MODIFY_HPP
 #define HYPERCSA_MODIFY_HPP
 #include "type_definitions.hpp"
+/*
+ * The versions with a target read hgraph and write the modified graph to the target, so hgraph stays untouched and a
+ * copy-on-write version is built without copying the old arrays first. The target may be hgraph itself. If a
+ * modification fails, the target is not written.
+ */
+int modify_delete_edge(const CompressedHyperGraph& hgraph, CompressedHyperGraph& target, Index pos);
 int modify_delete_edge(CompressedHyperGraph& hgraph, Index pos);
 
+int modify_delete_node_from_edge(const CompressedHyperGraph& hgraph, CompressedHyperGraph& target, Index pos, Node node);
 int modify_delete_node_from_edge(CompressedHyperGraph& hgraph, Index pos, Node node);
 
+// A node given twice is inserted once.
+int modify_insert_edge(const CompressedHyperGraph& hgraph, CompressedHyperGraph& target, Edge edge);
 int modify_insert_edge(CompressedHyperGraph& hgraph, Edge edge);
 
+int modify_insert_node_to_edge(const CompressedHyperGraph& hgraph, CompressedHyperGraph& target, Index pos, Node node);
 int modify_insert_node_to_edge(CompressedHyperGraph& hgraph, Index pos, Node node);
 
+// Position of the first node of a copy of the edge, or -1 if the edge does not exist.
+Index modify_find_edge(const CompressedHyperGraph& hgraph, Edge edge);
+
+// Position of the largest node of the edge with the stable id (see CompressedHyperGraph::ids), or -1 if the id was
+// deleted. An inserted edge gets the id next_id - 1.
+Index modify_find_id(const CompressedHyperGraph& hgraph, Index id);
+
 #endif //HYPERCSA_MODIFY_HPP
@@ -5,6 +5,7 @@
 #include "read.hpp"
 
 #include <algorithm>
+#include <chrono>
 
 #include <sdsl/int_vector.hpp>
 #include <sdsl/enc_vector.hpp>
@@ -15,10 +16,40 @@
 
 #include "util/type_definitions.hpp"
 #include "prints.hpp"
+#include "thread_pool.hpp"
 
 using namespace sdsl;
 using namespace std;
 
+// Maintain QueryStats only if enabled. Otherwise the macros only mark the stats as used, so that the queries compile
+// without warnings either way.
+#ifdef QUERY_STATS
+#define STATS_ADD(stats, counter, n) ((stats).counter += (n))
+#define STATS_START(start) auto start = chrono::steady_clock::now()
+#define STATS_TIME(stats, counter, start) \
+    ((stats).counter += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - (start)).count())
+#else
+#define STATS_ADD(stats, counter, n) ((void) (stats))
+#define STATS_START(start) ((void) 0)
+#define STATS_TIME(stats, counter, start) ((void) (stats))
+#endif
+
+QueryStats& QueryStats::operator+=(const QueryStats& other)
+{
+    queries += other.queries;
+    results += other.results;
+    psi_accesses += other.psi_accesses;
+    rank_calls += other.rank_calls;
+    select_calls += other.select_calls;
+    cycles_examined += other.cycles_examined;
+    cycles_pruned += other.cycles_pruned;
+    edges_decompressed += other.edges_decompressed;
+    postings_read += other.postings_read;
+    interval_ns += other.interval_ns;
+    scan_ns += other.scan_ns;
+    return *this;
+}
+
 bool read_edges_equal(CompressedHyperGraph &graph, Index edge1, Index edge2)
 {
     if (edge1 == edge2)
@@ -63,42 +94,126 @@ int binary_search_left_jumps(enc_vector<> *psi, uint64_t *from, const uint64_t *
     return 0;
 }
 
-int find_exact_next_interval(enc_vector<> *psi, uint64_t *from, uint64_t *to, uint64_t interval_start, uint64_t interval_end) {
-    // Solution by ChatGPT, but distance may be very inefficient.
+template<class P>
+int find_exact_next_interval(P *psi, uint64_t *from, uint64_t *to, uint64_t interval_start, uint64_t interval_end, QueryStats& stats) {
+    // Binary search on positions instead of iterators, so also the derived PSI of the dynamic backend can be used.
     // Finding `low` (smallest index where psi[low] >= next_from)
-    auto low_it = std::lower_bound(psi->begin() + (*from), psi->begin() + (*to), interval_start);
-    int low = std::distance(psi->begin(), low_it);
+    uint64_t low = *from, high = *to;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        STATS_ADD(stats, psi_accesses, 1);
+        if ((*psi)[middle] < interval_start)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    uint64_t result_low = low;
 
-    // Finding `high` (smallest index where psi[high] > next_to)
-    auto high_it = std::upper_bound(psi->begin() + (*from), psi->begin() + (*to), interval_end);
-    int high = std::distance(psi->begin(), high_it);
-    *from = low;
-    *to = high;
-    return low < high;
+    // Finding `high` (smallest index where psi[high] >= next_to), as interval_end is exclusive.
+    high = *to;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        STATS_ADD(stats, psi_accesses, 1);
+        if ((*psi)[middle] < interval_end)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    *from = result_low;
+    *to = low;
+    return result_low < low;
 }
 
-Edge decompress_edge(enc_vector<> *psi, rank_support_v<1>& rank_d, uint64_t index) {
-    vector<int64_t> nodes;
+// Calls emit for each node of the edge at index, starting at the smallest node.
+template<class P, class R, class F>
+void decompress_edge_nodes(P *psi, R& rank_d, uint64_t index, QueryStats& stats, F emit) {
     size_t j = (*psi)[index];
+    STATS_ADD(stats, edges_decompressed, 1);
+    STATS_ADD(stats, psi_accesses, 1);
     while (j != index)
     {
-        nodes.push_back((int64_t) rank_d(j+1)-1);
+        emit(rank_d(j+1)-1);
         j = (*psi)[j];
+        STATS_ADD(stats, psi_accesses, 1);
+        STATS_ADD(stats, rank_calls, 1);
     }
-    nodes.push_back((int64_t) rank_d(index+1)-1);
+    emit(rank_d(index+1)-1);
+    STATS_ADD(stats, rank_calls, 1);
+}
+
+template<class P, class R>
+Edge decompress_edge(P *psi, R& rank_d, uint64_t index, QueryStats& stats) {
+    static thread_local vector<uint64_t> nodes; // Reused, so only the edge itself is allocated.
+    nodes.clear();
+    decompress_edge_nodes(psi, rank_d, index, stats, [](uint64_t node) { nodes.push_back(node); });
     Edge e = Edge(nodes.size(), 0, 64);
     copy(nodes.begin(), nodes.end(), e.begin());
     return e;
 }
 
+/*
+ * Outputs of the queries. A query calls edge() for each result, so the results are only decompressed if needed.
+ */
+class EdgeListOutput {
+public:
+    EdgeList &edge_list;
+
+    explicit EdgeListOutput(EdgeList &list) : edge_list(list) {}
+
+    template<class P, class R>
+    void edge(P *psi, R& rank_d, uint64_t index, QueryStats& stats) { edge_list.push_back(decompress_edge(psi, rank_d, index, stats)); }
+};
+
+template<class T>
+class FlatOutput {
+public:
+    FlatEdgeList<T> &result;
+
+    explicit FlatOutput(FlatEdgeList<T> &r) : result(r) {}
+
+    template<class P, class R>
+    void edge(P *psi, R& rank_d, uint64_t index, QueryStats& stats) {
+        decompress_edge_nodes(psi, rank_d, index, stats, [this](uint64_t node) { result.nodes.push_back((T) node); });
+        result.offsets.push_back(result.nodes.size());
+    }
+};
+
+class CountOutput {
+public:
+    Index count = 0;
+
+    template<class P, class R>
+    void edge(P *, R&, uint64_t, QueryStats&) { count++; }
+};
+
+// Filter of the query results. before(i) is asked before the cycle of a candidate i is walked, after(i) for a match
+// and at_start(i) for a result given by its backward jump.
+class AcceptAll {
+public:
+    bool before(uint64_t) const { return true; }
+    bool after(uint64_t) const { return true; }
+    bool at_start(uint64_t) const { return true; }
+};
+
+EdgeList decompress_all_edges(CompressedHyperGraph &graph)
+{
+    rank_support_v<1> rank_d(&graph.D);
+    QueryStats stats;
+    EdgeList edge_list;
+    for (Index i = 0; i < graph.E.size(); i++)
+    {
+        if (graph.E[i]) // Backward jump, happens only once each edge.
+            edge_list.push_back(decompress_edge(&graph.PSI, rank_d, i, stats));
+    }
+    return edge_list;
+}
+
 #define EXACT 0
 #define CONTAINS 1
-EdgeList query_perform(enc_vector<> psi, const bit_vector& d, Edge query)
+template<class G, class O, class F>
+void query_perform(G& g, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, Edge query, O& output, F& filter, QueryStats& stats)
 {
-    // initialize structures for search.
-    rank_support_v<1> rank_d(&d);
-    select_support_mcl<1> select_d(&d);
-    EdgeList edge_list;
+    STATS_START(interval_start);
 
     // Sort the query for processing.
     sort(query.begin(), query.end());
@@ -110,32 +225,47 @@ EdgeList query_perform(enc_vector<> psi, const bit_vector& d, Edge query)
     // Find interval for node query[0].
     uint64_t from, to;
     from = select_d(query[0]), to = select_d(query[0]+1);
+    STATS_ADD(stats, select_calls, 2);
 
     // Goal: Find the interval that matches query[1] and the set of intervals that point to nodes lower than query[1].
     for (uint64_t i = 1; i < query.size(); i++)
     {
         uint64_t next_from = select_d(query[i]), next_to = select_d(query[i]+1);
-        int res = find_exact_next_interval(&psi, &from, &to, next_from, next_to);
+        STATS_ADD(stats, select_calls, 2);
+        int res = find_exact_next_interval(&g.PSI, &from, &to, next_from, next_to, stats);
         if (res == 0)
-            return edge_list; // No results found. Return an empty list.
-        from = psi[from];
-        to = psi[to-1]+1; //-1 +1 for staying in intervall and then extend it afterward.
+        {
+            STATS_TIME(stats, interval_ns, interval_start);
+            return; // No results found.
+        }
+        from = g.PSI[from];
+        to = g.PSI[to-1]+1; //-1 +1 for staying in intervall and then extend it afterward.
+        STATS_ADD(stats, psi_accesses, 2);
     }
 
     uint64_t next_from = select_d(query[0]), next_to = select_d(query[0]+1);
+    STATS_ADD(stats, select_calls, 2);
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
     for (uint64_t i = from; i < to; i++) // to is inclusive here in the current implementation
     {
-        if (next_from <= psi[i] && psi[i] < next_to) // <= i) // Check if edge has no further nodes (Psi[i] < i).
+        uint64_t first = g.PSI[i];
+        STATS_ADD(stats, psi_accesses, 1);
+        STATS_ADD(stats, cycles_examined, 1);
+        if (next_from <= first && first < next_to && filter.at_start(i)) // <= i) // Check if edge has no further nodes (Psi[i] < i).
             // Need to check psi[i] \in [from, to) to secure that there is no lower node.
         {
-            Edge e = decompress_edge(&psi, rank_d, i); // psi[i] is the smallest index of the edge.
-            edge_list.push_back(e);
+            STATS_ADD(stats, results, 1);
+            output.edge(&g.PSI, rank_d, i, stats); // psi[i] is the smallest index of the edge.
 #ifdef VERBOSE_DEBUG
+            Edge e = decompress_edge(&g.PSI, rank_d, i, stats);
             print_edge(&e);
 #endif
         }
+        else
+            STATS_ADD(stats, cycles_pruned, 1);
     }
-    return edge_list;
+    STATS_TIME(stats, scan_ns, scan_start);
 }
 
 // Deprecated, produces false positives.
@@ -144,6 +274,7 @@ EdgeList query_perform_contains(enc_vector<> psi, const bit_vector& d, Edge quer
     // initialize structures for search.
     rank_support_v<1> rank_d(&d);
     select_support_mcl<1,1> select_d(&d);
+    QueryStats stats;
     EdgeList edge_list;
 
     // Sort the query for processing.
@@ -168,7 +299,7 @@ EdgeList query_perform_contains(enc_vector<> psi, const bit_vector& d, Edge quer
             lower_to,
             from = si.lower_bound,
             to = si.higher_bound;
-        int res = find_exact_next_interval(&psi, &from, &to, next_from, next_to);
+        int res = find_exact_next_interval(&psi, &from, &to, next_from, next_to, stats);
 
 
         // Matches with steps that are not in the query.
@@ -201,7 +332,7 @@ EdgeList query_perform_contains(enc_vector<> psi, const bit_vector& d, Edge quer
             if (si.index+1 == query.size()) {
                 for (uint64_t i = from; i < to; i++) // to is exclusive in the current implementation
                 {
-                    Edge e = decompress_edge(&psi, rank_d, i); // TODO:
+                    Edge e = decompress_edge(&psi, rank_d, i, stats); // TODO:
                     // Check again that all nodes are connected, false positives are possible here.
                     // The false positives start with later nodes or skip the first node v_0.
                     edge_list.push_back(e);
@@ -215,11 +346,17 @@ EdgeList query_perform_contains(enc_vector<> psi, const bit_vector& d, Edge quer
     return edge_list;
 }
 
-EdgeList query_perform_contains_correct(CompressedHyperGraph& g, Edge& query)
+/*
+ * Contains query. excluded are the sorted, distinct, 1-based nodes that the results must not contain (empty for a plain
+ * contains query): the cycle visits the nodes increasing from the start node, and after one downward jump increasing
+ * up to it, so the excluded nodes are merged with it by a cursor that restarts at the jump, and the cycle is dropped at
+ * the first excluded node. Once all query nodes are found, the rest of the cycle lies between the last query node and
+ * the start node, and is only walked if an excluded node lies in that gap.
+ */
+template<class G, class O, class F>
+void query_perform_contains_correct(G& g, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, Edge& query, const vector<uint64_t>& excluded, O& output, F& filter, QueryStats& stats)
 {
-    rank_support_v<1> rank_d(&g.D);
-    select_support_mcl<1,1> select_d(&g.D);
-    EdgeList edge_list;
+    STATS_START(interval_start);
 
     // Sort the query for processing.
     sort(query.begin(), query.end());
@@ -228,67 +365,1270 @@ EdgeList query_perform_contains_correct(CompressedHyperGraph& g, Edge& query)
         query[i]++; // Add 1, as also the compression is 1-based on nodes.
     }
 
-    // Find smallest degree of nodes in query.
+    // Find smallest degree of nodes in query. Of equal intervals, the one without excluded nodes in the gap before it
+    // is taken, so its results end at the last query node.
+    auto gap_excluded = [&query, &excluded](size_t i) {
+        uint64_t low = query[(i + query.size() - 1) % query.size()], high = query[i];
+        auto next = upper_bound(excluded.begin(), excluded.end(), low);
+        if (low < high)
+            return next != excluded.end() && *next < high;
+        return next != excluded.end() || (!excluded.empty() && excluded.front() < high); // The gap wraps around.
+    };
     uint64_t min_interval = std::numeric_limits<uint64_t>::max();
     size_t best_start_node_index = 0;
+    bool best_gap = true;
     for (uint64_t i = 0; i < query.size(); i++) {
         uint64_t next_from = select_d(query[i]);
         uint64_t next_to = select_d(query[i] + 1);
+        STATS_ADD(stats, select_calls, 2);
         uint64_t interval_size = next_to - next_from;
 
-        if (interval_size < min_interval) {
+        if (interval_size < min_interval || (interval_size == min_interval && best_gap && !gap_excluded(i))) {
             min_interval = interval_size;
             best_start_node_index = i;
+            best_gap = !excluded.empty() && gap_excluded(i);
         }
     }
+    // The cursor of the excluded nodes after the start node.
+    uint64_t excluded_from = upper_bound(excluded.begin(), excluded.end(), query[best_start_node_index]) - excluded.begin();
 
     //Process each cycle of PSI starting from the interval of the smallest node-degree and check for the occurrence of nodes.
     uint64_t next_from = select_d(query[best_start_node_index]);
     uint64_t next_to = select_d(query[best_start_node_index] + 1);
+    STATS_ADD(stats, select_calls, 2);
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
     for (uint64_t i = next_from; i < next_to; i++)
     {
+        if (!filter.before(i))
+        {
+            STATS_ADD(stats, cycles_examined, 1);
+            STATS_ADD(stats, cycles_pruned, 1);
+            continue;
+        }
         uint64_t current_query_position = (best_start_node_index + 1) % query.size();
 
         uint64_t current_sa_position = g.PSI[i];
+        STATS_ADD(stats, psi_accesses, 1);
+        STATS_ADD(stats, cycles_examined, 1);
+        uint64_t excluded_position = current_sa_position <= i ? 0 : excluded_from;
+        bool excluded_seen = false;
+        // Advances the cursor to the node, true if it is excluded.
+        auto is_excluded = [&excluded, &excluded_position](uint64_t node) {
+            while (excluded_position < excluded.size() && excluded[excluded_position] < node)
+                excluded_position++;
+            return excluded_position < excluded.size() && excluded[excluded_position] == node;
+        };
         while (current_sa_position != i && current_query_position != best_start_node_index) {
             //__builtin_prefetch((const void *) &g.PSI[g.PSI[current_sa_position]], 0, 0); //One or more steps of Psi ahead?
             uint64_t node = rank_d(current_sa_position+1);
+            STATS_ADD(stats, rank_calls, 1);
             if (node > query[current_query_position] && current_query_position != 0) // Forward jump is greater than the next query node:
                 // this edge does not contain the next query node.
                 break; // Faster omit of not correct edge.
+            if (!excluded.empty() && (excluded_seen = is_excluded(node)))
+                break;
             if (node == query[current_query_position])
             {
                 current_query_position++;
                 current_query_position %= query.size();
             }
-            if (g.PSI[current_sa_position] <= current_sa_position && current_query_position != 0)
-                // Downward jump only allowed if the check for the next position is the lowest node (aka cur_qer_pos=0)
-                // Otherwise, a higher node is never reached by this edge.
-                break; // Faster omit of not correct edge.
-            current_sa_position = g.PSI[current_sa_position];
+            uint64_t next_sa_position = g.PSI[current_sa_position];
+            STATS_ADD(stats, psi_accesses, 1);
+            if (next_sa_position <= current_sa_position)
+            {
+                if (current_query_position != 0 && current_query_position != best_start_node_index)
+                    // Downward jump only allowed if the check for the next position is the lowest node (aka cur_qer_pos=0)
+                    // Otherwise, a higher node is never reached by this edge.
+                    break; // Faster omit of not correct edge.
+                excluded_position = 0;
+            }
+            current_sa_position = next_sa_position;
+        }
+        if (current_query_position == best_start_node_index && best_gap)
+        {
+            while (!excluded_seen && current_sa_position != i) // The rest of the cycle, for the excluded nodes in the gap.
+            {
+                excluded_seen = is_excluded(rank_d(current_sa_position + 1));
+                uint64_t next_sa_position = g.PSI[current_sa_position];
+                STATS_ADD(stats, rank_calls, 1);
+                STATS_ADD(stats, psi_accesses, 1);
+                if (next_sa_position <= current_sa_position)
+                    excluded_position = 0;
+                current_sa_position = next_sa_position;
+            }
         }
-        if (current_query_position == best_start_node_index)
+        if (current_query_position == best_start_node_index && !excluded_seen && filter.after(i))
         {
-            Edge e = decompress_edge(&g.PSI, rank_d, i);
-            edge_list.push_back(e);
+            STATS_ADD(stats, results, 1);
+            output.edge(&g.PSI, rank_d, i, stats);
 #ifdef VERBOSE_DEBUG
+            Edge e = decompress_edge(&g.PSI, rank_d, i, stats);
             print_edge(&e);
 #endif
         }
+        else
+            STATS_ADD(stats, cycles_pruned, 1);
     }
+    STATS_TIME(stats, scan_ns, scan_start);
+}
 
-    return edge_list;
+/*
+ * Each edge whose nodes are all in the query has its backward jump in the interval of its largest node, and jumps
+ * from there to the interval of its smallest node, both query nodes. As PSI is increasing within an interval, the
+ * candidates of a pair of query nodes are found by binary search, and no other positions are visited.
+ * The cycle of a candidate visits its nodes in increasing order, so it is merged with the sorted query and pruned
+ * at the first node that is not in the query.
+ */
+template<class G, class O, class F>
+void query_perform_subset(G& g, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, Edge& query, O& output, F& filter, QueryStats& stats)
+{
+    STATS_START(interval_start);
+
+    // Sort the query for processing.
+    vector<uint64_t> nodes(query.begin(), query.end());
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+    vector<uint64_t> starts(nodes.size()), ends(nodes.size());
+    for (size_t k = 0; k < nodes.size(); k++)
+    {
+        nodes[k]++; // Add 1, as also the compression is 1-based on nodes.
+        starts[k] = select_d(nodes[k]);
+        ends[k] = select_d(nodes[k] + 1);
+        STATS_ADD(stats, select_calls, 2);
+    }
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+
+    for (size_t largest = 0; largest < nodes.size(); largest++)
+    {
+        uint64_t cursor = starts[largest];
+        for (size_t smallest = 0; smallest <= largest && cursor < ends[largest]; smallest++)
+        {
+            uint64_t from = cursor, to = ends[largest];
+            if (!find_exact_next_interval(&g.PSI, &from, &to, starts[smallest], ends[smallest], stats))
+                continue;
+            cursor = to;
+            for (uint64_t i = from; i < to; i++)
+            {
+                uint64_t first = g.PSI[i];
+                STATS_ADD(stats, psi_accesses, 1);
+                STATS_ADD(stats, cycles_examined, 1);
+                if (first > i || !filter.at_start(i)) // Within the same interval, only the backward jump is a start.
+                {
+                    STATS_ADD(stats, cycles_pruned, 1);
+                    continue;
+                }
+                size_t k = smallest;
+                bool subset = true;
+                uint64_t j = first;
+                while (subset && (j = g.PSI[j]) != i)
+                {
+                    uint64_t node = rank_d(j + 1);
+                    STATS_ADD(stats, psi_accesses, 1);
+                    STATS_ADD(stats, rank_calls, 1);
+                    while (nodes[k] < node) // The edge ends at nodes[largest], so k stays within the query.
+                        k++;
+                    subset = nodes[k] == node;
+                }
+                if (subset)
+                {
+                    STATS_ADD(stats, results, 1);
+                    output.edge(&g.PSI, rank_d, i, stats);
+                }
+                else
+                    STATS_ADD(stats, cycles_pruned, 1);
+            }
+        }
+    }
+    STATS_TIME(stats, scan_ns, scan_start);
 }
 
-EdgeList query(CompressedHyperGraph& graph, Edge query, int type)
+/*
+ * The edges whose smallest nodes are the sorted query. The positions of the interval of query[0] are sorted by the nodes
+ * that follow in their cycle, and PSI is increasing within each interval. So on the positions whose next j - 1 nodes are
+ * query[1] to query[j-1], PSI applied j times is increasing as well, and the positions followed by query[j] are found
+ * by binary search, without leaving the interval of query[0]. The remaining positions have the query as consecutive
+ * nodes; the rest of the cycle is walked to its backward jump, which has to return to the position itself, so that
+ * query[0] is the smallest node.
+ */
+template<class G, class O, class F>
+void query_perform_prefix(G& g, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, Edge& query, O& output, F& filter, QueryStats& stats)
+{
+    STATS_START(interval_start);
+
+    // Sort the query for processing.
+    sort(query.begin(), query.end());
+    for (int i=0; i < query.size(); i++)
+    {
+        query[i]++; // Add 1, as also the compression is 1-based on nodes.
+    }
+
+    uint64_t from = select_d(query[0]), to = select_d(query[0] + 1);
+    STATS_ADD(stats, select_calls, 2);
+    for (uint64_t j = 1; j < query.size() && from < to; j++)
+    {
+        uint64_t next_from = select_d(query[j]), next_to = select_d(query[j] + 1);
+        STATS_ADD(stats, select_calls, 2);
+        auto follow = [&g, &stats, j](uint64_t p) { // The position of the j-th next node.
+            for (uint64_t step = 0; step < j; step++)
+                p = g.PSI[p];
+            STATS_ADD(stats, psi_accesses, j);
+            return p;
+        };
+        uint64_t low = from, high = to;
+        while (low < high)
+        {
+            uint64_t middle = low + (high - low) / 2;
+            if (follow(middle) < next_from)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        from = low, high = to;
+        while (low < high)
+        {
+            uint64_t middle = low + (high - low) / 2;
+            if (follow(middle) < next_to)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        to = low;
+    }
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+    for (uint64_t i = from; i < to; i++)
+    {
+        uint64_t start = i, next;
+        STATS_ADD(stats, cycles_examined, 1);
+        while ((next = g.PSI[start]) > start) // Up to the largest node of the edge.
+        {
+            start = next;
+            STATS_ADD(stats, psi_accesses, 1);
+        }
+        STATS_ADD(stats, psi_accesses, 1);
+        if (next == i && filter.at_start(start))
+        {
+            STATS_ADD(stats, results, 1);
+            output.edge(&g.PSI, rank_d, start, stats);
+        }
+        else
+            STATS_ADD(stats, cycles_pruned, 1);
+    }
+    STATS_TIME(stats, scan_ns, scan_start);
+}
+
+/*
+ * The edges whose nodes all lie in [query[0], query[1]]. The backward jump of such an edge is in the interval of its
+ * largest node and jumps to the interval of its smallest node, both in the range. PSI is increasing within an interval,
+ * so the positions of each node v in the range that jump to the range up to v are found by binary search. Besides steps
+ * between a node repeated in an edge, all of them are results, and no other positions are visited.
+ */
+template<class G, class O, class F>
+void query_perform_range(G& g, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, const Edge& query, O& output, F& filter, QueryStats& stats)
+{
+    STATS_START(interval_start);
+    uint64_t nodes = rank_d(g.D.size()) - 1;
+    STATS_ADD(stats, rank_calls, 1);
+    if (query.size() != 2 || query[0] > query[1] || query[0] >= nodes)
+        return;
+    uint64_t low = query[0] + 1, high = min<uint64_t>(query[1], nodes - 1) + 1; // 1-based.
+    uint64_t range_from = select_d(low);
+    STATS_ADD(stats, select_calls, 1);
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+
+    uint64_t interval_from = range_from;
+    for (uint64_t v = low; v <= high; v++)
+    {
+        uint64_t interval_to = select_d(v + 1);
+        STATS_ADD(stats, select_calls, 1);
+        uint64_t from = interval_from, to = interval_to;
+        if (find_exact_next_interval(&g.PSI, &from, &to, range_from, interval_to, stats))
+        {
+            for (uint64_t i = from; i < to; i++)
+            {
+                STATS_ADD(stats, cycles_examined, 1);
+                STATS_ADD(stats, psi_accesses, 1);
+                if (g.PSI[i] <= i && filter.at_start(i))
+                {
+                    STATS_ADD(stats, results, 1);
+                    output.edge(&g.PSI, rank_d, i, stats);
+                }
+                else
+                    STATS_ADD(stats, cycles_pruned, 1);
+            }
+        }
+        interval_from = interval_to;
+    }
+    STATS_TIME(stats, scan_ns, scan_start);
+}
+
+/*
+ * The edges that share a node with the query, each once, for graphs without the supports on E that
+ * query_perform_overlap uses. Each position of the intervals of the query nodes is walked up to the backward jump of
+ * its edge, and the edges of the sorted backward jumps are reported once.
+ */
+template<class G, class O, class F>
+void query_perform_overlap_walk(G& g, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, const Edge& query, O& output, F& filter, QueryStats& stats)
+{
+    STATS_START(interval_start);
+    uint64_t nodes = rank_d(g.D.size()) - 1;
+    STATS_ADD(stats, rank_calls, 1);
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+
+    vector<uint64_t> starts;
+    for (Node node : query)
+    {
+        if (node >= nodes) // Nodes outside of D are in no edge.
+            continue;
+        uint64_t from = select_d(node + 1), to = select_d(node + 2);
+        STATS_ADD(stats, select_calls, 2);
+        for (uint64_t i = from; i < to; i++)
+        {
+            uint64_t start = i, next;
+            while ((next = g.PSI[start]) > start)
+            {
+                start = next;
+                STATS_ADD(stats, psi_accesses, 1);
+            }
+            STATS_ADD(stats, psi_accesses, 1);
+            starts.push_back(start);
+        }
+    }
+    sort(starts.begin(), starts.end()); // An edge with several query nodes is reported once.
+    starts.erase(unique(starts.begin(), starts.end()), starts.end());
+    for (uint64_t start : starts)
+    {
+        STATS_ADD(stats, cycles_examined, 1);
+        if (filter.at_start(start))
+        {
+            STATS_ADD(stats, results, 1);
+            output.edge(&g.PSI, rank_d, start, stats);
+        }
+        else
+            STATS_ADD(stats, cycles_pruned, 1);
+    }
+    STATS_TIME(stats, scan_ns, scan_start);
+}
+
+template<class G, class O, class F>
+void query_graph(G& graph, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, Edge query, int type, O& output, F& filter, QueryStats& stats)
 {
     switch (type) {
         case EXACT:
-            return query_perform(graph.PSI, graph.D, std::move(query));
+            query_perform(graph, rank_d, select_d, std::move(query), output, filter, stats);
             break;
         case CONTAIN:
-            return query_perform_contains_correct(graph, query);
+            query_perform_contains_correct(graph, rank_d, select_d, query, vector<uint64_t>(), output, filter, stats);
             break;
-        default: return {};
+        case SUBSET:
+            query_perform_subset(graph, rank_d, select_d, query, output, filter, stats);
+            break;
+        case PREFIX:
+            query_perform_prefix(graph, rank_d, select_d, query, output, filter, stats);
+            break;
+        case RANGE:
+            query_perform_range(graph, rank_d, select_d, query, output, filter, stats);
+            break;
+        case OVERLAP: // Only reached without the prepared supports, e.g. on the dynamic graph.
+            query_perform_overlap_walk(graph, rank_d, select_d, query, output, filter, stats);
+            break;
+        default: break;
+    }
+}
+
+template<class G, class O>
+void query_graph(G& graph, typename G::rank_1_type& rank_d, typename G::select_1_type& select_d, Edge query, int type, O& output, QueryStats& stats)
+{
+    AcceptAll filter;
+    query_graph(graph, rank_d, select_d, std::move(query), type, output, filter, stats);
+}
+
+template<class G>
+EdgeList query_graph(G& graph, Edge query, int type)
+{
+    // initialize structures for search.
+    typename G::rank_1_type rank_d(&graph.D);
+    typename G::select_1_type select_d(&graph.D);
+    QueryStats stats;
+    EdgeList edge_list;
+    EdgeListOutput output(edge_list);
+    query_graph(graph, rank_d, select_d, std::move(query), type, output, stats);
+    return edge_list;
+}
+
+EdgeList query(CompressedHyperGraph& graph, Edge query, int type)
+{
+    if (type == OVERLAP) // Needs the supports on E.
+    {
+        PreparedHyperGraph prepared(graph);
+        return ::query(prepared, std::move(query), type);
+    }
+    return query_graph(graph, std::move(query), type);
+}
+
+EdgeList query(DynamicHyperGraph& graph, Edge query, int type)
+{
+    return query_graph(graph, std::move(query), type);
+}
+
+PreparedHyperGraph::PreparedHyperGraph(CompressedHyperGraph &g)
+        : graph(g), rank_d(&g.D), select_d(&g.D), rank_e(&g.E), select_e(&g.E)
+{
+    nodes = rank_d(graph.D.size()) - 1;
+    edges = rank_e(graph.E.size());
+}
+
+void prepared_build_sizes(PreparedHyperGraph &prepared)
+{
+    call_once(prepared.sizes_built, [&prepared]() {
+        prepared.sizes = edge_sizes(prepared.graph.PSI, prepared.graph.E);
+        prepared.size_counts = edge_size_counts(prepared.sizes);
+    });
+}
+
+Index edge_position(PreparedHyperGraph& prepared, Index edge_id)
+{
+    return prepared.select_e(edge_id + 1);
+}
+
+Index edge_id(PreparedHyperGraph& prepared, Index position)
+{
+    return prepared.rank_e(edge_start(prepared.graph, prepared.samples, position));
+}
+
+Index stable_id(PreparedHyperGraph& prepared, Index position)
+{
+    return prepared.graph.ids[edge_id(prepared, position)];
+}
+
+Index stable_position(PreparedHyperGraph& prepared, Index id)
+{
+    Index rank = edge_id_rank(prepared.graph, id);
+    if (rank == (Index) -1)
+        return -1;
+    return edge_position(prepared, rank);
+}
+
+bool read_edges_equal(PreparedHyperGraph& prepared, Index edge1, Index edge2)
+{
+    if (edge1 == edge2)
+        return true;
+    return edge_start(prepared.graph, prepared.samples, edge1) == edge_start(prepared.graph, prepared.samples, edge2);
+}
+
+Edge decompress_edge_by_id(PreparedHyperGraph& prepared, Index edge_id)
+{
+    QueryStats stats;
+    return decompress_edge(&prepared.graph.PSI, prepared.rank_d, edge_position(prepared, edge_id), stats);
+}
+
+FlatEdgeList<uint64_t> decompress_all_edges(PreparedHyperGraph& prepared, unsigned threads)
+{
+    FlatEdgeList<uint64_t> all;
+    uint64_t ranges = max<uint64_t>(1, min<uint64_t>(prepared.edges, 4 * (uint64_t) max(1u, threads)));
+    vector<FlatEdgeList<uint64_t>> parts(ranges);
+    {
+        ThreadPool pool(max(1u, threads));
+        for (uint64_t r = 0; r < ranges; r++)
+        {
+            pool.submit([&prepared, &parts, r, ranges]() {
+                QueryStats stats;
+                FlatOutput<uint64_t> output(parts[r]);
+                for (Index id = prepared.edges * r / ranges; id < prepared.edges * (r + 1) / ranges; id++)
+                    output.edge(&prepared.graph.PSI, prepared.rank_d, edge_position(prepared, id), stats);
+            });
+        }
+    } // Waits for all ranges.
+    for (FlatEdgeList<uint64_t>& part : parts)
+    {
+        uint64_t shift = all.nodes.size();
+        all.nodes.insert(all.nodes.end(), part.nodes.begin(), part.nodes.end());
+        for (size_t i = 1; i < part.offsets.size(); i++)
+            all.offsets.push_back(part.offsets[i] + shift);
+    }
+    return all;
+}
+
+bool prepared_in_graph(PreparedHyperGraph &prepared, const Edge &query)
+{
+    if (query.size() == 0)
+        return false;
+    for (Node node : query)
+    {
+        if (node >= prepared.nodes)
+            return false; // Nodes outside of D can not occur in any edge.
+    }
+    return true;
+}
+
+void prepared_build_hubs(PreparedHyperGraph &prepared, uint64_t k)
+{
+    prepared.hubs = hub_build(prepared.graph, prepared.select_d, prepared.nodes, k, prepared.samples);
+}
+
+void prepared_build_samples(PreparedHyperGraph &prepared, uint64_t rate)
+{
+    edge_samples_build(prepared.samples, prepared.graph, rate);
+}
+
+// Answers a contains query of only hubs by intersecting their posting lists. Returns false if it is not applicable.
+template<class O, class F>
+bool query_hubs(PreparedHyperGraph& prepared, const Edge& query, O& output, F& filter, QueryStats& stats)
+{
+    static thread_local vector<Index> positions;
+    uint64_t postings_read = 0;
+    STATS_START(scan_start);
+    if (!hub_contains(prepared.hubs, query, positions, postings_read))
+        return false;
+    STATS_ADD(stats, postings_read, postings_read);
+    for (Index position : positions)
+    {
+        if (!filter.at_start(position))
+            continue;
+        STATS_ADD(stats, results, 1);
+        output.edge(&prepared.graph.PSI, prepared.rank_d, position, stats); // The backward jump, so sorted nodes.
+    }
+    STATS_TIME(stats, scan_ns, scan_start);
+    return true;
+}
+
+/*
+ * Edges that share at least threshold of the n distinct query nodes. Such an edge has one of them in any
+ * n - threshold + 1 of the intervals, so only the smallest n - threshold + 1 intervals are scanned, and their
+ * positions are mapped to the start of their edge (faster with samples). After sorting the starts, the length of a
+ * run is the number of scanned intervals that hit the edge. An edge with fewer hits is verified by walking its cycle,
+ * which visits the nodes in increasing order, so it is merged with the sorted query and pruned as soon as the
+ * remaining query nodes can not reach the threshold.
+ */
+template<class O, class F>
+void query_perform_overlap(PreparedHyperGraph& prepared, Edge& query, uint64_t threshold, O& output, F& filter, QueryStats& stats)
+{
+    CompressedHyperGraph& g = prepared.graph;
+    STATS_START(interval_start);
+
+    // Sort the query for processing.
+    vector<uint64_t> nodes(query.begin(), query.end());
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+    threshold = max<uint64_t>(threshold, 1);
+    if (threshold > nodes.size())
+        return;
+    vector<pair<uint64_t, uint64_t>> intervals(nodes.size());
+    for (size_t k = 0; k < nodes.size(); k++)
+    {
+        nodes[k]++; // Add 1, as also the compression is 1-based on nodes.
+        intervals[k] = {prepared.select_d(nodes[k]), prepared.select_d(nodes[k] + 1)};
+        STATS_ADD(stats, select_calls, 2);
+    }
+    sort(intervals.begin(), intervals.end(), [](const pair<uint64_t, uint64_t>& a, const pair<uint64_t, uint64_t>& b) {
+        return a.second - a.first < b.second - b.first;
+    });
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+
+    static thread_local vector<Index> starts, interval_starts; // Reused, so repeated queries do not allocate.
+    starts.clear();
+    for (size_t k = 0; k + threshold <= nodes.size(); k++)
+    {
+        interval_starts.clear();
+        for (Index p = intervals[k].first; p < intervals[k].second; p++)
+            interval_starts.push_back(edge_start(g, prepared.samples, p));
+        sort(interval_starts.begin(), interval_starts.end()); // A node twice in an edge is one hit.
+        interval_starts.erase(unique(interval_starts.begin(), interval_starts.end()), interval_starts.end());
+        starts.insert(starts.end(), interval_starts.begin(), interval_starts.end());
+    }
+    sort(starts.begin(), starts.end());
+
+    for (size_t run = 0, next; run < starts.size(); run = next)
+    {
+        Index start = starts[run];
+        for (next = run + 1; next < starts.size() && starts[next] == start; next++);
+        uint64_t hits = next - run;
+        STATS_ADD(stats, cycles_examined, 1);
+        if (!filter.at_start(start))
+        {
+            STATS_ADD(stats, cycles_pruned, 1);
+            continue;
+        }
+        if (hits < threshold) // Counts all query nodes of the edge.
+        {
+            hits = 0;
+            size_t k = 0;
+            Index j = start;
+            do
+            {
+                j = g.PSI[j];
+                uint64_t node = prepared.rank_d(j + 1);
+                STATS_ADD(stats, psi_accesses, 1);
+                STATS_ADD(stats, rank_calls, 1);
+                while (k < nodes.size() && nodes[k] < node)
+                    k++;
+                if (k < nodes.size() && nodes[k] == node)
+                {
+                    hits++;
+                    k++;
+                }
+            } while (j != start && hits < threshold && hits + (nodes.size() - k) >= threshold);
+        }
+        if (hits < threshold)
+        {
+            STATS_ADD(stats, cycles_pruned, 1);
+            continue;
+        }
+        STATS_ADD(stats, results, 1);
+        output.edge(&g.PSI, prepared.rank_d, start, stats);
+    }
+    STATS_TIME(stats, scan_ns, scan_start);
+}
+
+template<class O, class F>
+void query_prepared(PreparedHyperGraph& prepared, Edge query, int type, O& output, F& filter, QueryStats& stats, uint64_t threshold = 1)
+{
+    STATS_ADD(stats, queries, 1);
+    if (type == SUBSET || type == OVERLAP) // Nodes outside of D are in no edge, so they do not change the result.
+    {
+        Index kept = 0;
+        for (Node node : query)
+            if (node < prepared.nodes)
+                query[kept++] = node;
+        query.resize(kept);
+    }
+    if (type != RANGE && !prepared_in_graph(prepared, query)) // The range is bounded by the query itself.
+        return;
+    if (type == CONTAIN && !prepared.hubs.empty() && query_hubs(prepared, query, output, filter, stats))
+        return;
+    if (type == OVERLAP)
+    {
+        query_perform_overlap(prepared, query, threshold, output, filter, stats);
+        return;
+    }
+    query_graph(prepared.graph, prepared.rank_d, prepared.select_d, std::move(query), type, output, filter, stats);
+}
+
+template<class O>
+void query_prepared(PreparedHyperGraph& prepared, Edge query, int type, O& output, QueryStats& stats)
+{
+    AcceptAll filter;
+    query_prepared(prepared, std::move(query), type, output, filter, stats);
+}
+
+/*
+ * Accepts the edges with min_size to max_size nodes. With samples, the size of a candidate is looked up before its
+ * cycle is walked, otherwise only the matches are looked up, as reaching the start is a walk itself.
+ */
+class SizeFilter {
+    PreparedHyperGraph& prepared;
+    uint64_t min_size, max_size;
+
+public:
+    SizeFilter(PreparedHyperGraph& p, uint64_t min, uint64_t max) : prepared(p), min_size(min), max_size(max)
+    {
+        prepared_build_sizes(prepared);
+    }
+
+    bool at_start(uint64_t start) const
+    {
+        if (!prepared.graph.E[start]) // An exact query of a repeated node, its results need not end at the start.
+            start = edge_start(prepared.graph, prepared.samples, start);
+        uint64_t size = prepared.sizes[prepared.rank_e(start)];
+        return min_size <= size && size <= max_size;
+    }
+    bool before(uint64_t i) const
+    {
+        return prepared.samples.empty() || at_start(edge_start(prepared.graph, prepared.samples, i));
+    }
+    bool after(uint64_t i) const
+    {
+        return !prepared.samples.empty() || at_start(edge_start(prepared.graph, prepared.samples, i));
+    }
+
+    // False if no edge can pass, by the histogram of the sizes and for contains by the number of distinct query nodes.
+    bool possible(const Edge& query, int type) const
+    {
+        vector<Node> nodes(query.begin(), query.end());
+        sort(nodes.begin(), nodes.end());
+        uint64_t least = type == CONTAIN ? unique(nodes.begin(), nodes.end()) - nodes.begin() : 0;
+        const vector<uint64_t>& counts = prepared.size_counts;
+        for (uint64_t k = max(min_size, least); k <= max_size && k < counts.size(); k++)
+        {
+            if (counts[k] > 0)
+                return true;
+        }
+        return false;
+    }
+};
+
+template<class O>
+void query_sized(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size, O& output, QueryStats& stats)
+{
+    SizeFilter filter(prepared, min_size, max_size);
+    if (!filter.possible(query, type))
+    {
+        STATS_ADD(stats, queries, 1);
+        return;
+    }
+    query_prepared(prepared, std::move(query), type, output, filter, stats);
+}
+
+EdgeList query(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size)
+{
+    QueryStats stats;
+    EdgeList edge_list;
+    EdgeListOutput output(edge_list);
+    query_sized(prepared, std::move(query), type, min_size, max_size, output, stats);
+    return edge_list;
+}
+
+Index query(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size,
+            FlatEdgeList<uint64_t>& result, QueryStats& stats)
+{
+    if (result.offsets.empty())
+        result.offsets.push_back(0);
+    Index before = result.size();
+    FlatOutput<uint64_t> output(result);
+    query_sized(prepared, std::move(query), type, min_size, max_size, output, stats);
+    return result.size() - before;
+}
+
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size, QueryStats& stats)
+{
+    CountOutput output;
+    query_sized(prepared, std::move(query), type, min_size, max_size, output, stats);
+    return output.count;
+}
+
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size)
+{
+    QueryStats stats;
+    return query_count(prepared, std::move(query), type, min_size, max_size, stats);
+}
+
+EdgeList query_overlap(PreparedHyperGraph& prepared, Edge query, uint64_t threshold, QueryStats& stats)
+{
+    EdgeList edge_list;
+    EdgeListOutput output(edge_list);
+    AcceptAll filter;
+    query_prepared(prepared, std::move(query), OVERLAP, output, filter, stats, threshold);
+    return edge_list;
+}
+
+EdgeList query_overlap(PreparedHyperGraph& prepared, Edge query, uint64_t threshold)
+{
+    QueryStats stats;
+    return query_overlap(prepared, std::move(query), threshold, stats);
+}
+
+Index query_overlap(PreparedHyperGraph& prepared, Edge query, uint64_t threshold, FlatEdgeList<uint64_t>& result, QueryStats& stats)
+{
+    if (result.offsets.empty())
+        result.offsets.push_back(0);
+    Index before = result.size();
+    FlatOutput<uint64_t> output(result);
+    AcceptAll filter;
+    query_prepared(prepared, std::move(query), OVERLAP, output, filter, stats, threshold);
+    return result.size() - before;
+}
+
+Index query_overlap_count(PreparedHyperGraph& prepared, Edge query, uint64_t threshold)
+{
+    QueryStats stats;
+    CountOutput output;
+    AcceptAll filter;
+    query_prepared(prepared, std::move(query), OVERLAP, output, filter, stats, threshold);
+    return output.count;
+}
+
+#define JACCARD_CHUNK 4096 // Positions of an interval that one task maps to their edges.
+
+// a is more similar than b, ties are broken by the smaller id.
+bool jaccard_better(const SimilarEdge& a, const SimilarEdge& b)
+{
+    uint64_t left = a.shared * b.union_size, right = b.shared * a.union_size;
+    return left != right ? left > right : a.id < b.id;
+}
+
+// The interval of a query node.
+class JaccardInterval {
+public:
+    Node node;
+    Index from, to;
+};
+
+// The k-th best similarity of the candidates, which needs at least k candidates.
+SimilarEdge jaccard_kth(vector<pair<Index, SimilarEdge>> candidates, uint64_t k)
+{
+    nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(),
+                [](const pair<Index, SimilarEdge>& a, const pair<Index, SimilarEdge>& b) {
+                    return jaccard_better(a.second, b.second);
+                });
+    return candidates[k - 1].second;
+}
+
+/*
+ * Every edge that shares a node with the query has a position in one of the intervals of the query nodes. The
+ * intervals are scanned from the smallest to the largest, in chunks in parallel, and each position is mapped to the
+ * start of its edge. With samples (prepared_build_samples), this takes less than rate steps, without them the cycle is
+ * walked up to its backward jump. The size of an edge in PreparedHyperGraph::sizes gives the union without walking
+ * the cycle, so the shared nodes found so far give a lower bound of the similarity of each candidate.
+ * An edge that is not a candidate yet shares at most the r remaining query nodes, so its similarity is at most r / n.
+ * Once that is below the k-th lower bound, the remaining intervals are not scanned. Instead, the cycles of the
+ * candidates that can still reach the k-th lower bound are walked to count their remaining shared nodes.
+ */
+vector<SimilarEdge> query_jaccard(PreparedHyperGraph& prepared, Edge query, uint64_t k, unsigned threads, QueryStats& stats)
+{
+    CompressedHyperGraph& g = prepared.graph;
+    vector<SimilarEdge> best;
+    STATS_ADD(stats, queries, 1);
+    STATS_START(interval_start);
+
+    vector<Node> nodes(query.begin(), query.end());
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+    uint64_t n = nodes.size(); // Nodes outside of D are in the union, but in no interval.
+    if (k == 0 || n == 0)
+        return best;
+    prepared_build_sizes(prepared);
+    vector<JaccardInterval> intervals; // Of the nodes in D, from the smallest to the largest.
+    for (uint64_t q = 0; q < n && nodes[q] < prepared.nodes; q++)
+    {
+        intervals.push_back({nodes[q], prepared.select_d(nodes[q] + 1), prepared.select_d(nodes[q] + 2)});
+        STATS_ADD(stats, select_calls, 2);
+    }
+    stable_sort(intervals.begin(), intervals.end(), [](const JaccardInterval& a, const JaccardInterval& b) {
+        return a.to - a.from < b.to - b.from;
+    });
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+
+    unique_ptr<ThreadPool> pool; // Started for the first interval that is split.
+    vector<pair<Index, SimilarEdge>> candidates; // By start, with the shared nodes of the scanned intervals.
+    uint64_t scanned = n - intervals.size(); // The nodes outside of D are done.
+    for (const JaccardInterval& interval : intervals)
+    {
+        uint64_t rest = n - scanned;
+        if (candidates.size() >= k)
+        {
+            SimilarEdge kth = jaccard_kth(candidates, k);
+            if (rest * kth.union_size < kth.shared * n)
+                break;
+        }
+        vector<pair<Index, Index>> chunks;
+        for (Index p = interval.from; p < interval.to; p += JACCARD_CHUNK)
+            chunks.emplace_back(p, min<Index>(interval.to, p + JACCARD_CHUNK));
+        vector<vector<Index>> parts(chunks.size()); // The start of each position.
+        auto scan = [&prepared, &g, &chunks, &parts](uint64_t c) {
+            for (Index p = chunks[c].first; p < chunks[c].second; p++)
+                parts[c].push_back(edge_start(g, prepared.samples, p));
+        };
+        if (threads > 1 && chunks.size() > 1)
+        {
+            if (!pool)
+                pool = make_unique<ThreadPool>(threads);
+            vector<future<void>> done;
+            for (uint64_t c = 0; c < chunks.size(); c++)
+                done.push_back(pool->submit([&scan, c]() { scan(c); }));
+            for (future<void>& chunk : done)
+                chunk.get();
+        }
+        else
+        {
+            for (uint64_t c = 0; c < chunks.size(); c++)
+                scan(c);
+        }
+        vector<Index> starts;
+        for (vector<Index>& part : parts)
+            starts.insert(starts.end(), part.begin(), part.end());
+        sort(starts.begin(), starts.end());
+        starts.erase(unique(starts.begin(), starts.end()), starts.end()); // A node twice in an edge is shared once.
+
+        vector<pair<Index, SimilarEdge>> merged;
+        merged.reserve(candidates.size() + starts.size());
+        size_t i_candidates = 0;
+        for (Index start : starts)
+        {
+            while (i_candidates < candidates.size() && candidates[i_candidates].first < start)
+                merged.push_back(candidates[i_candidates++]);
+            if (i_candidates < candidates.size() && candidates[i_candidates].first == start)
+            {
+                merged.push_back(candidates[i_candidates++]);
+                merged.back().second.shared++;
+                merged.back().second.union_size--;
+                continue;
+            }
+            SimilarEdge candidate;
+            candidate.id = prepared.rank_e(start);
+            candidate.shared = 1;
+            candidate.union_size = n + prepared.sizes[candidate.id] - 1;
+            STATS_ADD(stats, rank_calls, 1);
+            merged.emplace_back(start, candidate);
+        }
+        merged.insert(merged.end(), candidates.begin() + i_candidates, candidates.end());
+        candidates = std::move(merged);
+        scanned++;
+    }
+
+    if (scanned < n) // Count the shared nodes of the intervals that were not scanned on the cycles instead.
+    {
+        vector<Node> rest_nodes;
+        for (uint64_t i = intervals.size() - (n - scanned); i < intervals.size(); i++)
+            rest_nodes.push_back(intervals[i].node);
+        sort(rest_nodes.begin(), rest_nodes.end());
+        SimilarEdge kth = jaccard_kth(candidates, k);
+        vector<pair<Index, SimilarEdge>> verified;
+        for (pair<Index, SimilarEdge>& candidate : candidates)
+        {
+            SimilarEdge& edge = candidate.second;
+            uint64_t size = edge.union_size + edge.shared - n;
+            uint64_t most = min<uint64_t>(edge.shared + rest_nodes.size(), size);
+            if (most * kth.union_size < kth.shared * (n + size - most))
+            {
+                STATS_ADD(stats, cycles_pruned, 1);
+                continue;
+            }
+            vector<Node> found;
+            Index position = candidate.first;
+            do {
+                Node node = prepared.rank_d(position + 1) - 1;
+                if (binary_search(rest_nodes.begin(), rest_nodes.end(), node))
+                    found.push_back(node);
+                position = g.PSI[position];
+                STATS_ADD(stats, rank_calls, 1);
+                STATS_ADD(stats, psi_accesses, 1);
+            } while (position != candidate.first);
+            sort(found.begin(), found.end());
+            uint64_t shared = unique(found.begin(), found.end()) - found.begin();
+            edge.shared += shared;
+            edge.union_size -= shared;
+            verified.push_back(candidate);
+        }
+        candidates = std::move(verified);
+    }
+
+    for (pair<Index, SimilarEdge>& candidate : candidates)
+    {
+        STATS_ADD(stats, cycles_examined, 1);
+        if (best.size() < k)
+        {
+            best.push_back(candidate.second);
+            push_heap(best.begin(), best.end(), jaccard_better); // The front is the worst.
+        }
+        else if (jaccard_better(candidate.second, best.front()))
+        {
+            pop_heap(best.begin(), best.end(), jaccard_better);
+            best.back() = candidate.second;
+            push_heap(best.begin(), best.end(), jaccard_better);
+        }
+        else
+            STATS_ADD(stats, cycles_pruned, 1);
+    }
+    sort(best.begin(), best.end(), jaccard_better);
+    for (SimilarEdge& edge : best)
+        edge.similarity = (double) edge.shared / edge.union_size;
+    STATS_ADD(stats, results, best.size());
+    STATS_TIME(stats, scan_ns, scan_start);
+    return best;
+}
+
+vector<SimilarEdge> query_jaccard(PreparedHyperGraph& prepared, Edge query, uint64_t k, unsigned threads)
+{
+    QueryStats stats;
+    return query_jaccard(prepared, std::move(query), k, threads, stats);
+}
+
+#define NEIGHBOR_PARALLEL_MIN 4096 // Smaller intervals are walked by the calling thread alone.
+
+/*
+ * Each position of the interval of the node is one of its edges, whose cycle visits all other nodes of the edge, so
+ * rank_d gives the neighbors directly. Intervals of at least NEIGHBOR_PARALLEL_MIN positions (the hubs) are split into
+ * ranges that are walked in parallel. Each range sorts its neighbors and counts runs, and the counts of the ranges are
+ * merged the same way.
+ */
+vector<Neighbor> query_neighbors(PreparedHyperGraph& prepared, Node node, uint64_t k, unsigned threads, QueryStats& stats)
+{
+    CompressedHyperGraph& g = prepared.graph;
+    vector<Neighbor> neighbors;
+    STATS_ADD(stats, queries, 1);
+    if (node >= prepared.nodes)
+        return neighbors;
+    STATS_START(interval_start);
+    Index from = prepared.select_d(node + 1), to = prepared.select_d(node + 2);
+    STATS_ADD(stats, select_calls, 2);
+    STATS_TIME(stats, interval_ns, interval_start);
+    STATS_START(scan_start);
+
+    uint64_t ranges = 1;
+    if (threads > 1 && to - from >= NEIGHBOR_PARALLEL_MIN)
+        ranges = min<uint64_t>((to - from) / (NEIGHBOR_PARALLEL_MIN / 4), 4 * (uint64_t) threads);
+    vector<vector<Neighbor>> parts(ranges);
+    vector<QueryStats> part_stats(ranges);
+    auto walk = [&prepared, &g, &parts, &part_stats, from, to, ranges, node](uint64_t r) {
+        vector<Node> nodes;
+        QueryStats& stats = part_stats[r];
+        for (Index i = from + (to - from) * r / ranges; i < from + (to - from) * (r + 1) / ranges; i++)
+        {
+            STATS_ADD(stats, cycles_examined, 1);
+            for (Index j = g.PSI[i]; j != i; j = g.PSI[j])
+            {
+                Node neighbor = prepared.rank_d(j + 1) - 1;
+                STATS_ADD(stats, psi_accesses, 1);
+                STATS_ADD(stats, rank_calls, 1);
+                if (neighbor != node) // A node repeated in an edge is no neighbor of itself.
+                    nodes.push_back(neighbor);
+            }
+            STATS_ADD(stats, psi_accesses, 1);
+        }
+        sort(nodes.begin(), nodes.end());
+        for (size_t run = 0, next; run < nodes.size(); run = next)
+        {
+            for (next = run + 1; next < nodes.size() && nodes[next] == nodes[run]; next++);
+            parts[r].push_back({nodes[run], next - run});
+        }
+    };
+    if (ranges > 1)
+    {
+        ThreadPool pool(threads);
+        for (uint64_t r = 0; r < ranges; r++)
+            pool.submit([&walk, r]() { walk(r); });
+    } // Waits for all ranges.
+    else
+        walk(0);
+
+    for (uint64_t r = 0; r < ranges; r++)
+    {
+        neighbors.insert(neighbors.end(), parts[r].begin(), parts[r].end());
+        stats += part_stats[r];
+    }
+    if (ranges > 1)
+    {
+        sort(neighbors.begin(), neighbors.end(), [](const Neighbor& a, const Neighbor& b) { return a.node < b.node; });
+        size_t kept = 0;
+        for (size_t i = 0; i < neighbors.size(); i++)
+        {
+            if (kept > 0 && neighbors[kept - 1].node == neighbors[i].node)
+                neighbors[kept - 1].count += neighbors[i].count;
+            else
+                neighbors[kept++] = neighbors[i];
+        }
+        neighbors.resize(kept);
+    }
+    auto more = [](const Neighbor& a, const Neighbor& b) { return a.count != b.count ? a.count > b.count : a.node < b.node; };
+    if (k > 0 && k < neighbors.size())
+    {
+        partial_sort(neighbors.begin(), neighbors.begin() + k, neighbors.end(), more);
+        neighbors.resize(k);
+    }
+    else
+        sort(neighbors.begin(), neighbors.end(), more);
+    STATS_ADD(stats, results, neighbors.size());
+    STATS_TIME(stats, scan_ns, scan_start);
+    return neighbors;
+}
+
+vector<Neighbor> query_neighbors(PreparedHyperGraph& prepared, Node node, uint64_t k, unsigned threads)
+{
+    QueryStats stats;
+    return query_neighbors(prepared, node, k, threads, stats);
+}
+
+template<class O>
+void query_boolean_prepared(PreparedHyperGraph& prepared, Edge required, const Edge& excluded, O& output, QueryStats& stats)
+{
+    vector<uint64_t> nodes; // 1-based, excluded nodes outside of D are in no edge anyway.
+    for (Node node : excluded)
+    {
+        if (node < prepared.nodes)
+            nodes.push_back(node + 1);
+    }
+    if (nodes.empty()) // A plain contains query, which may use the hubs.
+    {
+        query_prepared(prepared, std::move(required), CONTAIN, output, stats);
+        return;
+    }
+    STATS_ADD(stats, queries, 1);
+    if (!prepared_in_graph(prepared, required))
+        return;
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+    for (Node node : required)
+    {
+        if (binary_search(nodes.begin(), nodes.end(), node + 1))
+            return; // A node is required and excluded.
+    }
+    AcceptAll filter;
+    query_perform_contains_correct(prepared.graph, prepared.rank_d, prepared.select_d, required, nodes, output, filter, stats);
+}
+
+EdgeList query_boolean(PreparedHyperGraph& prepared, Edge required, const Edge& excluded, QueryStats& stats)
+{
+    EdgeList edge_list;
+    EdgeListOutput output(edge_list);
+    query_boolean_prepared(prepared, std::move(required), excluded, output, stats);
+    return edge_list;
+}
+
+EdgeList query_boolean(PreparedHyperGraph& prepared, Edge required, const Edge& excluded)
+{
+    QueryStats stats;
+    return query_boolean(prepared, std::move(required), excluded, stats);
+}
+
+Index query_boolean(PreparedHyperGraph& prepared, Edge required, const Edge& excluded, FlatEdgeList<uint64_t>& result, QueryStats& stats)
+{
+    if (result.offsets.empty())
+        result.offsets.push_back(0);
+    Index before = result.size();
+    FlatOutput<uint64_t> output(result);
+    query_boolean_prepared(prepared, std::move(required), excluded, output, stats);
+    return result.size() - before;
+}
+
+Index query_boolean_count(PreparedHyperGraph& prepared, Edge required, const Edge& excluded)
+{
+    QueryStats stats;
+    CountOutput output;
+    query_boolean_prepared(prepared, std::move(required), excluded, output, stats);
+    return output.count;
+}
+
+Index node_degree(PreparedHyperGraph& prepared, Node node)
+{
+    if (node >= prepared.nodes)
+        return 0;
+    return prepared.select_d(node + 2) - prepared.select_d(node + 1);
+}
+
+vector<Index> node_degrees(PreparedHyperGraph& prepared, const vector<Node>& nodes)
+{
+    vector<Index> degrees(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++)
+        degrees[i] = node_degree(prepared, nodes[i]);
+    return degrees;
+}
+
+// a has a higher degree than b, ties are broken by the smaller node.
+bool degree_higher(const NodeDegree& a, const NodeDegree& b)
+{
+    return a.degree != b.degree ? a.degree > b.degree : a.node < b.node;
+}
+
+/*
+ * The nodes are split into ranges, and each range is one pass of consecutive selects over its part of D, with a heap
+ * of its k highest degrees. The heaps of the ranges are merged at the end.
+ */
+vector<NodeDegree> top_degrees(PreparedHyperGraph& prepared, uint64_t k, unsigned threads)
+{
+    vector<NodeDegree> top;
+    k = min<uint64_t>(k, prepared.nodes);
+    if (k == 0)
+        return top;
+    uint64_t ranges = max<uint64_t>(1, min<uint64_t>(prepared.nodes / 4096, 4 * (uint64_t) max(1u, threads)));
+    vector<vector<NodeDegree>> parts(ranges);
+    auto scan = [&prepared, &parts, ranges, k](uint64_t r) {
+        vector<NodeDegree>& heap = parts[r]; // The front is the lowest of the kept degrees.
+        Node from = prepared.nodes * r / ranges, to = prepared.nodes * (r + 1) / ranges;
+        Index start = prepared.select_d(from + 1);
+        for (Node v = from; v < to; v++)
+        {
+            Index end = prepared.select_d(v + 2);
+            NodeDegree node{v, end - start};
+            start = end;
+            if (heap.size() < k)
+            {
+                heap.push_back(node);
+                push_heap(heap.begin(), heap.end(), degree_higher);
+            }
+            else if (degree_higher(node, heap.front()))
+            {
+                pop_heap(heap.begin(), heap.end(), degree_higher);
+                heap.back() = node;
+                push_heap(heap.begin(), heap.end(), degree_higher);
+            }
+        }
+    };
+    if (threads > 1 && ranges > 1)
+    {
+        ThreadPool pool(threads);
+        for (uint64_t r = 0; r < ranges; r++)
+            pool.submit([&scan, r]() { scan(r); });
+    } // Waits for all ranges.
+    else
+    {
+        for (uint64_t r = 0; r < ranges; r++)
+            scan(r);
     }
-}
\ No newline at end of file
+    for (vector<NodeDegree>& part : parts)
+        top.insert(top.end(), part.begin(), part.end());
+    partial_sort(top.begin(), top.begin() + k, top.end(), degree_higher);
+    top.resize(k);
+    return top;
+}
+
+const vector<uint64_t>& cardinality_histogram(PreparedHyperGraph& prepared)
+{
+    prepared_build_sizes(prepared);
+    return prepared.size_counts;
+}
+
+EdgeList query(PreparedHyperGraph& prepared, Edge query, int type, QueryStats& stats)
+{
+    EdgeList edge_list;
+    EdgeListOutput output(edge_list);
+    query_prepared(prepared, std::move(query), type, output, stats);
+    return edge_list;
+}
+
+EdgeList query(PreparedHyperGraph& prepared, Edge query, int type)
+{
+    QueryStats stats;
+    return ::query(prepared, std::move(query), type, stats);
+}
+
+template<class T>
+Index query_flat(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<T>& result, QueryStats& stats)
+{
+    if (result.offsets.empty())
+        result.offsets.push_back(0);
+    Index before = result.size();
+    FlatOutput<T> output(result);
+    query_prepared(prepared, std::move(query), type, output, stats);
+    return result.size() - before;
+}
+
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint64_t>& result, QueryStats& stats)
+{
+    return query_flat(prepared, std::move(query), type, result, stats);
+}
+
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint64_t>& result)
+{
+    QueryStats stats;
+    return query_flat(prepared, std::move(query), type, result, stats);
+}
+
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint32_t>& result, QueryStats& stats)
+{
+    return query_flat(prepared, std::move(query), type, result, stats);
+}
+
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint32_t>& result)
+{
+    QueryStats stats;
+    return query_flat(prepared, std::move(query), type, result, stats);
+}
+
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type, QueryStats& stats)
+{
+    CountOutput output;
+    query_prepared(prepared, std::move(query), type, output, stats);
+    return output.count;
+}
+
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type)
+{
+    QueryStats stats;
+    return query_count(prepared, std::move(query), type, stats);
+}
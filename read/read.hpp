@@ -5,12 +5,180 @@
 #ifndef HYPERCSA_READ_HPP
 #define HYPERCSA_READ_HPP
 
+#include <mutex>
+
 #include "type_definitions.hpp"
+#include "hubs.hpp"
 using namespace std;
 
 bool read_edges_equal(CompressedHyperGraph &graph, Index edge1, Index edge2);
 EdgeIterator query_iterator(CompressedHyperGraph& graph, Edge query, int type);
 Index next(EdgeIterator);
 EdgeList query(CompressedHyperGraph& graph, Edge query, int type);
+EdgeList query(DynamicHyperGraph& graph, Edge query, int type);
+EdgeList decompress_all_edges(CompressedHyperGraph &graph);
+
+/*
+ * Rank and select supports on D and E, built once and shared by all queries on the graph.
+ * The graph must stay at its place while it is prepared.
+ */
+class PreparedHyperGraph {
+public:
+    CompressedHyperGraph &graph;
+    CompressedHyperGraph::rank_1_type rank_d;
+    CompressedHyperGraph::select_1_type select_d;
+    CompressedHyperGraph::rank_1_type rank_e;
+    CompressedHyperGraph::select_1_type select_e;
+    Index nodes;
+    Index edges;
+    HubIndex hubs; // Optional, empty until prepared_build_hubs.
+    EdgeSamples samples; // Optional, empty until prepared_build_samples.
+    // Number of nodes of the i-th edge of E and the histogram of these sizes, see prepared_build_sizes.
+    sdsl::int_vector<> sizes;
+    std::vector<uint64_t> size_counts;
+    std::once_flag sizes_built;
+
+    explicit PreparedHyperGraph(CompressedHyperGraph &g);
+};
+
+/*
+ * Edge ids are the ranks of the backward jumps in E, so they are 0 to edges-1 in the order of the largest node.
+ * The ids are only valid for one version of the graph, a modification can change them.
+ */
+Index edge_position(PreparedHyperGraph& prepared, Index edge_id); // The backward jump of the edge.
+Index edge_id(PreparedHyperGraph& prepared, Index position); // The id of the edge with the position.
+bool read_edges_equal(PreparedHyperGraph& prepared, Index edge1, Index edge2); // Same start, see samples.hpp.
+Index stable_id(PreparedHyperGraph& prepared, Index position); // The stable id of the edge with the position.
+Index stable_position(PreparedHyperGraph& prepared, Index id); // The backward jump of the edge, -1 if deleted.
+Edge decompress_edge_by_id(PreparedHyperGraph& prepared, Index edge_id); // Sorted nodes.
+// All edges in id order. The ids are split into ranges that are decompressed in parallel.
+FlatEdgeList<uint64_t> decompress_all_edges(PreparedHyperGraph& prepared, unsigned threads);
+
+// Builds posting lists for the k nodes with the highest degree, see hubs.hpp. Contains queries of only these nodes
+// then intersect the lists instead of walking cycles.
+void prepared_build_hubs(PreparedHyperGraph &prepared, uint64_t k);
+// Walks every cycle once for the sizes of the edges. The size filters, the histogram and the similarity queries call it
+// on their first use, so a graph that is only loaded or modified does not pay for it. Safe to call from several threads.
+void prepared_build_sizes(PreparedHyperGraph &prepared);
+// Samples every rate-th position of each cycle, see samples.hpp. Edge ids and equality of positions of large edges
+// then take less than rate steps. Build them before the hubs, so the hub build uses them as well.
+void prepared_build_samples(PreparedHyperGraph &prepared, uint64_t rate);
+
+/*
+ * Work done by queries, to see why a query is slow. The counters are only maintained if the library is built with
+ * QUERY_STATS (cmake option), otherwise they stay 0 and cost nothing.
+ * The queries add to the counters, so one object aggregates a batch of queries.
+ */
+class QueryStats {
+public:
+#ifdef QUERY_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    uint64_t queries = 0;
+    uint64_t results = 0;
+    uint64_t psi_accesses = 0;
+    uint64_t rank_calls = 0;
+    uint64_t select_calls = 0;
+    uint64_t cycles_examined = 0; // Candidate edges whose cycle is walked.
+    uint64_t cycles_pruned = 0; // Candidates rejected before their cycle is complete.
+    uint64_t edges_decompressed = 0;
+    uint64_t postings_read = 0; // Entries of hub posting lists.
+    uint64_t interval_ns = 0; // Phase 1: finding the start interval(s).
+    uint64_t scan_ns = 0; // Phase 2: checking the candidates and writing the results.
+
+    QueryStats& operator+=(const QueryStats& other);
+};
+
+// Queries with nodes outside of the graph have no results.
+EdgeList query(PreparedHyperGraph& prepared, Edge query, int type);
+EdgeList query(PreparedHyperGraph& prepared, Edge query, int type, QueryStats& stats);
+// Appends the results to the flat buffer and returns their number. The 32 bit version requires less than 2^32 nodes.
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint64_t>& result);
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint64_t>& result, QueryStats& stats);
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint32_t>& result);
+Index query(PreparedHyperGraph& prepared, Edge query, int type, FlatEdgeList<uint32_t>& result, QueryStats& stats);
+// Counts the results without decompressing them.
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type);
+
+/*
+ * Queries that only return edges with min_size to max_size nodes, by PreparedHyperGraph::sizes.
+ * With samples (prepared_build_samples), the candidates of contains queries are pruned before their cycle is walked.
+ */
+EdgeList query(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size);
+Index query(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size,
+            FlatEdgeList<uint64_t>& result, QueryStats& stats);
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size);
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type, uint64_t min_size, uint64_t max_size, QueryStats& stats);
+/*
+ * Overlap queries: the edges that share at least threshold of the distinct query nodes, each edge once. query() with
+ * type OVERLAP uses a threshold of 1. Query nodes outside of the graph are ignored.
+ */
+EdgeList query_overlap(PreparedHyperGraph& prepared, Edge query, uint64_t threshold);
+EdgeList query_overlap(PreparedHyperGraph& prepared, Edge query, uint64_t threshold, QueryStats& stats);
+Index query_overlap(PreparedHyperGraph& prepared, Edge query, uint64_t threshold, FlatEdgeList<uint64_t>& result, QueryStats& stats);
+Index query_overlap_count(PreparedHyperGraph& prepared, Edge query, uint64_t threshold);
+
+/*
+ * Boolean queries: the edges that contain all required nodes and none of the excluded nodes. The contains walk drops a
+ * cycle at the first excluded node, so the results are not filtered afterwards. Without excluded nodes in the graph,
+ * this is query() with type CONTAIN.
+ */
+EdgeList query_boolean(PreparedHyperGraph& prepared, Edge required, const Edge& excluded);
+EdgeList query_boolean(PreparedHyperGraph& prepared, Edge required, const Edge& excluded, QueryStats& stats);
+Index query_boolean(PreparedHyperGraph& prepared, Edge required, const Edge& excluded, FlatEdgeList<uint64_t>& result, QueryStats& stats);
+Index query_boolean_count(PreparedHyperGraph& prepared, Edge required, const Edge& excluded);
+
+/*
+ * An edge of a similarity query. The similarity is the Jaccard similarity shared / union_size of the distinct query
+ * nodes and the nodes of the edge, where the edge counts a repeated node twice.
+ */
+class SimilarEdge {
+public:
+    Index id; // The id of edge_position.
+    uint64_t shared;
+    uint64_t union_size;
+    double similarity;
+};
+
+// The k edges most similar to the query, by decreasing similarity and then by id. The intervals of the query nodes
+// are scanned by threads threads, a query server already parallel over its requests passes 1.
+std::vector<SimilarEdge> query_jaccard(PreparedHyperGraph& prepared, Edge query, uint64_t k, unsigned threads = 1);
+std::vector<SimilarEdge> query_jaccard(PreparedHyperGraph& prepared, Edge query, uint64_t k, unsigned threads, QueryStats& stats);
+
+/*
+ * A node that shares count edges with the node of a neighborhood query. An edge with a repeated node is counted for
+ * each occurrence.
+ */
+class Neighbor {
+public:
+    Node node;
+    uint64_t count;
+};
+
+// The neighbors of the node by decreasing count and then by node, only the first k unless k is 0. The cycles of the
+// edges of the node are walked without decompressing them, by threads threads if the node has many edges.
+std::vector<Neighbor> query_neighbors(PreparedHyperGraph& prepared, Node node, uint64_t k, unsigned threads = 1);
+std::vector<Neighbor> query_neighbors(PreparedHyperGraph& prepared, Node node, uint64_t k, unsigned threads, QueryStats& stats);
+
+/*
+ * The degree of a node is the number of its edges, the length of its interval in D, so it takes two selects. Nodes
+ * outside of the graph have degree 0. An edge with the node several times is counted for each occurrence.
+ */
+class NodeDegree {
+public:
+    Node node;
+    Index degree;
+};
+
+Index node_degree(PreparedHyperGraph& prepared, Node node);
+std::vector<Index> node_degrees(PreparedHyperGraph& prepared, const std::vector<Node>& nodes);
+// The k nodes with the highest degree, by decreasing degree and then by node, in one pass over D by threads threads.
+std::vector<NodeDegree> top_degrees(PreparedHyperGraph& prepared, uint64_t k, unsigned threads = 1);
+
+// counts[k] is the number of edges with k nodes, kept with the graph, so this is O(1) and reading it O(sigma).
+const std::vector<uint64_t>& cardinality_histogram(PreparedHyperGraph& prepared);
+Index query_count(PreparedHyperGraph& prepared, Edge query, int type, QueryStats& stats);
 
 #endif //HYPERCSA_READ_HPP
@@ -0,0 +1,162 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "report.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <sdsl/structure_tree.hpp>
+
+using namespace sdsl;
+using namespace std;
+
+class Distribution {
+public:
+    map<uint64_t, uint64_t> histogram; // value -> number of occurrences
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    void add(uint64_t value) {
+        histogram[value]++;
+        count++;
+        sum += value;
+    }
+
+    uint64_t percentile(double p) const {
+        uint64_t rank = (uint64_t) (p * count), seen = 0;
+        for (auto& entry : histogram)
+        {
+            seen += entry.second;
+            if (seen > rank)
+                return entry.first;
+        }
+        return histogram.empty() ? 0 : histogram.rbegin()->first;
+    }
+};
+
+void report_json_string(ostream& out, const string& s)
+{
+    out << '"';
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+void report_distribution(ostream& out, const Distribution& d)
+{
+    out << "{\"count\": " << d.count
+        << ", \"min\": " << (d.histogram.empty() ? 0 : d.histogram.begin()->first)
+        << ", \"max\": " << (d.histogram.empty() ? 0 : d.histogram.rbegin()->first)
+        << ", \"mean\": " << (d.count == 0 ? 0.0 : (double) d.sum / d.count)
+        << ", \"p50\": " << d.percentile(0.5) << ", \"p90\": " << d.percentile(0.9) << ", \"p99\": " << d.percentile(0.99)
+        << ", \"histogram\": [";
+    bool first = true;
+    for (auto& entry : d.histogram)
+    {
+        out << (first ? "" : ", ") << "[" << entry.first << ", " << entry.second << "]";
+        first = false;
+    }
+    out << "]}";
+}
+
+void report_structure(ostream& out, const structure_tree_node* node)
+{
+    out << "{\"name\": ";
+    report_json_string(out, node->name);
+    out << ", \"type\": ";
+    report_json_string(out, node->type);
+    out << ", \"bytes\": " << node->size;
+    if (!node->children.empty())
+    {
+        out << ", \"children\": [";
+        bool first = true;
+        for (auto& child : node->children)
+        {
+            out << (first ? "" : ", ");
+            report_structure(out, child.second.get());
+            first = false;
+        }
+        out << "]";
+    }
+    out << "}";
+}
+
+// Sums the bytes of the nodes below node whose name contains part, e.g. the samples of an enc_vector.
+uint64_t report_bytes_named(const structure_tree_node* node, const string& part)
+{
+    uint64_t bytes = 0;
+    for (auto& child : node->children)
+    {
+        if (child.second->name.find(part) != string::npos)
+            bytes += child.second->size;
+        else
+            bytes += report_bytes_named(child.second.get(), part);
+    }
+    return bytes;
+}
+
+int write_space_report(PreparedHyperGraph& prepared, ostream& out)
+{
+    CompressedHyperGraph& graph = prepared.graph;
+    unique_ptr<structure_tree_node> root(new structure_tree_node("hypercsa", "CompressedHyperGraph"));
+    nullstream null_out;
+    uint64_t d_bytes = graph.D.serialize(null_out, root.get(), "D");
+    uint64_t psi_bytes = graph.PSI.serialize(null_out, root.get(), "PSI");
+    uint64_t e_bytes = graph.E.serialize(null_out, root.get(), "E");
+    uint64_t ids_bytes = graph.ids.serialize(null_out, root.get(), "ids");
+    uint64_t id_ranks_bytes = graph.id_ranks.serialize(null_out, root.get(), "id_ranks");
+    prepared_build_sizes(prepared);
+    uint64_t sizes_bytes = prepared.sizes.serialize(null_out, root.get(), "sizes");
+    uint64_t rank_bytes = prepared.rank_d.serialize(null_out, root.get(), "rank_d");
+    uint64_t select_bytes = prepared.select_d.serialize(null_out, root.get(), "select_d");
+    uint64_t e_support_bytes = prepared.rank_e.serialize(null_out, root.get(), "rank_e")
+                               + prepared.select_e.serialize(null_out, root.get(), "select_e");
+    uint64_t bytes = d_bytes + psi_bytes + e_bytes + ids_bytes;
+    uint64_t support_bytes = rank_bytes + select_bytes + e_support_bytes + sizes_bytes
+                             + id_ranks_bytes; // The sizes and id ranks are not stored.
+    structure_tree::add_size(root.get(), bytes + support_bytes);
+    const structure_tree_node* psi_node = root->children.at("PSI").get();
+    uint64_t sample_bytes = report_bytes_named(psi_node, "sample");
+    uint64_t delta_bytes = report_bytes_named(psi_node, "delta");
+
+    Distribution degrees, cardinalities;
+    for (Index v = 0; v < prepared.nodes; v++)
+        degrees.add(prepared.select_d(v + 2) - prepared.select_d(v + 1));
+    for (Index id = 0; id < prepared.edges; id++)
+        cardinalities.add(prepared.sizes[id]);
+
+    Index incidences = graph.PSI.size();
+    double bits_per_incidence = incidences == 0 ? 0.0 : 8.0 * bytes / incidences;
+    out << "{\n";
+    out << "  \"nodes\": " << prepared.nodes << ",\n";
+    out << "  \"edges\": " << prepared.edges << ",\n";
+    out << "  \"incidences\": " << incidences << ",\n";
+    out << "  \"bytes\": " << bytes << ",\n";
+    out << "  \"bytes_with_supports\": " << bytes + support_bytes << ",\n";
+    out << "  \"bits_per_incidence\": " << bits_per_incidence << ",\n";
+    out << "  \"D\": {\"bits\": " << graph.D.size() << ", \"ones\": " << prepared.nodes + 1 << ", \"bytes\": " << d_bytes
+        << ", \"rank_support_bytes\": " << rank_bytes << ", \"select_support_bytes\": " << select_bytes << "},\n";
+    out << "  \"PSI\": {\"entries\": " << incidences << ", \"sample_density\": " << graph.PSI.get_sample_dens()
+        << ", \"bytes\": " << psi_bytes << ", \"sample_bytes\": " << sample_bytes << ", \"delta_bytes\": " << delta_bytes
+        << ", \"other_bytes\": " << psi_bytes - sample_bytes - delta_bytes << "},\n";
+    out << "  \"E\": {\"bits\": " << graph.E.size() << ", \"ones\": " << prepared.edges << ", \"bytes\": " << e_bytes
+        << ", \"support_bytes\": " << e_support_bytes << "},\n";
+    out << "  \"ids\": {\"next_id\": " << graph.next_id << ", \"bytes\": " << ids_bytes << ", \"rank_bytes\": "
+        << id_ranks_bytes << "},\n";
+    out << "  \"sizes\": {\"width\": " << (int) prepared.sizes.width() << ", \"bytes\": " << sizes_bytes << "},\n";
+    out << "  \"node_degree\": ";
+    report_distribution(out, degrees);
+    out << ",\n  \"edge_cardinality\": ";
+    report_distribution(out, cardinalities);
+    out << ",\n  \"structure\": ";
+    report_structure(out, root.get());
+    out << "\n}\n";
+    return out.good() ? 0 : -1;
+}
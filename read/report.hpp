@@ -0,0 +1,23 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_REPORT_HPP
+#define HYPERCSA_REPORT_HPP
+
+#include <ostream>
+
+#include "type_definitions.hpp"
+#include "read.hpp"
+
+/*
+ * Writes the space breakdown of the graph as JSON:
+ * - the sizes of D, E and their rank and select supports, of PSI split into samples and encoded deltas, and of the
+ *   stable ids and the edge sizes,
+ * - bits per incidence,
+ * - the distributions of node degree and edge cardinality (count, min, max, mean, percentiles and histogram),
+ * - the full sdsl structure tree of D, PSI and the supports.
+ */
+int write_space_report(PreparedHyperGraph& prepared, std::ostream& out);
+
+#endif //HYPERCSA_REPORT_HPP
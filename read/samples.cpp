@@ -0,0 +1,61 @@
+//
+// Created by Enno Adler on 19.10.26.
+//
+
+#include "samples.hpp"
+
+using namespace sdsl;
+using namespace std;
+
+void edge_samples_build(EdgeSamples& samples, CompressedHyperGraph& graph, uint64_t rate)
+{
+    samples = EdgeSamples();
+    if (rate == 0)
+        return;
+    samples.S = bit_vector(graph.PSI.size(), 0);
+
+    // 1. Mark every rate-th position of each cycle.
+    uint64_t marked = 0;
+    for (Index i = 0; i < graph.E.size(); i++)
+    {
+        if (!graph.E[i])
+            continue;
+        uint64_t step = 1;
+        for (Index j = graph.PSI[i]; j != i; j = graph.PSI[j], step++)
+        {
+            if (step % rate == 0)
+            {
+                samples.S[j] = 1;
+                marked++;
+            }
+        }
+    }
+    samples.rank_s = rank_support_v<1>(&samples.S);
+
+    // 2. Store the starts in the order of the marked positions.
+    samples.starts = int_vector<>(marked, 0);
+    for (Index i = 0; i < graph.E.size(); i++)
+    {
+        if (!graph.E[i])
+            continue;
+        uint64_t step = 1;
+        for (Index j = graph.PSI[i]; j != i; j = graph.PSI[j], step++)
+        {
+            if (step % rate == 0)
+                samples.starts[samples.rank_s(j)] = i;
+        }
+    }
+    util::bit_compress(samples.starts);
+    samples.rate = rate;
+}
+
+Index edge_start(CompressedHyperGraph& graph, const EdgeSamples& samples, Index position)
+{
+    while (!graph.E[position])
+    {
+        if (!samples.empty() && samples.S[position])
+            return samples.starts[samples.rank_s(position)];
+        position = graph.PSI[position];
+    }
+    return position;
+}
@@ -0,0 +1,34 @@
+//
+// Created by Enno Adler on 19.10.26.
+//
+
+#ifndef HYPERCSA_SAMPLES_HPP
+#define HYPERCSA_SAMPLES_HPP
+
+#include "type_definitions.hpp"
+
+#define EDGE_SAMPLE_DEFAULT_RATE 32
+
+/*
+ * Samples of the edge starts, like the SA samples of a CSA. Along each cycle, every rate-th position after the
+ * backward jump (the start of the edge) is marked in S and stores the start. From any position, the start is then
+ * reached after less than rate steps, instead of walking up to the whole cycle. Edges with at most rate nodes have
+ * no samples, E is reached fast enough.
+ * The samples belong to one version of the graph and have to be rebuilt after a modification.
+ */
+class EdgeSamples {
+public:
+    uint64_t rate = 0; // 0 until built.
+    sdsl::bit_vector S;
+    sdsl::rank_support_v<1> rank_s;
+    sdsl::int_vector<> starts; // The start of the edge of the i-th marked position.
+
+    bool empty() const { return rate == 0; }
+};
+
+// Builds the samples in place, as rank_s points to S.
+void edge_samples_build(EdgeSamples& samples, CompressedHyperGraph& graph, uint64_t rate);
+// The backward jump of the edge with the position. Without samples, it walks along the cycle.
+Index edge_start(CompressedHyperGraph& graph, const EdgeSamples& samples, Index position);
+
+#endif //HYPERCSA_SAMPLES_HPP
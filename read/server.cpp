@@ -0,0 +1,293 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "server.hpp"
+#include "parse.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <set>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+QueryServer::QueryServer(CompressedHyperGraph g, unsigned threads)
+        : graph(std::move(g)), prepared(graph), pool(threads) {}
+
+// Parses a comma-separated list of nodes. Returns false if a token is no number.
+bool server_parse_nodes(const string &list, Edge &edge)
+{
+    vector<uint64_t> values;
+    stringstream ss(list);
+    string token;
+    while (getline(ss, token, ','))
+    {
+        if (token.empty())
+            continue;
+        size_t parsed = 0;
+        try {
+            values.push_back(stoull(token, &parsed));
+        }
+        catch (...) {
+            return false;
+        }
+        if (parsed != token.size())
+            return false;
+    }
+    edge = Edge(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        edge[i] = values[i];
+    return true;
+}
+
+string server_handle_request(QueryServer &server, const string &request)
+{
+    stringstream ss(request);
+    string command, list;
+    bool count_only = false;
+    uint64_t threshold = 1;
+    ss >> command;
+    if (command == "count")
+    {
+        count_only = true;
+        ss >> command;
+    }
+    if (command == "overlap" && !(ss >> threshold))
+        return "ERR expected a threshold\n";
+    if (command == "neighbors")
+    {
+        uint64_t k;
+        Node node;
+        if (count_only || !(ss >> k >> node))
+            return count_only ? "ERR unknown request\n" : "ERR expected a number of neighbors and a node\n";
+        if (ss >> list)
+            return "ERR unexpected text after the node\n";
+        vector<Neighbor> neighbors = query_neighbors(server.prepared, node, k, 1); // The workers are parallel already.
+        string answer = to_string(neighbors.size()) + "\n";
+        for (const Neighbor& neighbor : neighbors)
+            answer += to_string(neighbor.node) + " " + to_string(neighbor.count) + "\n";
+        return answer;
+    }
+    if (command == "similar" && (count_only || !(ss >> threshold)))
+        return count_only ? "ERR unknown request\n" : "ERR expected a number of edges\n";
+    ss >> list;
+    string rest;
+    if (ss >> rest)
+        return "ERR unexpected text after the nodes\n";
+
+    int type = -1;
+    if (command == "exact")
+        type = EXACT;
+    else if (command == "contains")
+        type = CONTAIN;
+    else if (command == "subset")
+        type = SUBSET;
+    else if (command == "overlap")
+        type = OVERLAP;
+    else if (command == "prefix")
+        type = PREFIX;
+    else if (command == "range")
+        type = RANGE;
+    else if (command != "similar")
+        return "ERR unknown request\n";
+    Edge edge, excluded;
+    if (type == CONTAIN ? parse_boolean_query(list, edge, excluded) < 0 : !server_parse_nodes(list, edge))
+        return "ERR expected a comma-separated list of nodes\n";
+    if (edge.size() == 0)
+        return "ERR expected a comma-separated list of nodes\n";
+
+    if (command == "similar") // The workers already serve requests in parallel, so one thread per request.
+    {
+        vector<SimilarEdge> best = query_jaccard(server.prepared, edge, threshold, 1);
+        string answer = to_string(best.size()) + "\n";
+        for (const SimilarEdge& similar : best)
+        {
+            Edge nodes = decompress_edge_by_id(server.prepared, similar.id);
+            answer += to_string(similar.id) + " " + to_string(similar.similarity) + " ";
+            for (size_t j = 0; j < nodes.size(); j++)
+                answer += (j == 0 ? "" : ",") + to_string(nodes[j]);
+            answer += "\n";
+        }
+        return answer;
+    }
+
+    if (count_only)
+        return to_string(type == OVERLAP ? query_overlap_count(server.prepared, edge, threshold)
+                         : excluded.size() > 0 ? query_boolean_count(server.prepared, edge, excluded)
+                                               : query_count(server.prepared, edge, type)) + "\n";
+
+    static thread_local FlatEdgeList<uint64_t> result; // Reused by the requests on this worker.
+    result.clear();
+    QueryStats stats;
+    if (type == OVERLAP)
+        query_overlap(server.prepared, edge, threshold, result, stats);
+    else if (excluded.size() > 0)
+        query_boolean(server.prepared, edge, excluded, result, stats);
+    else
+        query(server.prepared, edge, type, result, stats);
+    string answer = to_string(result.size()) + "\n";
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        for (uint64_t j = result.offsets[i]; j < result.offsets[i + 1]; j++)
+            answer += (j == result.offsets[i] ? "" : ",") + to_string(result.nodes[j]);
+        answer += "\n";
+    }
+    return answer;
+}
+
+int server_write_all(int fd, const string &data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t result = write(fd, data.data() + written, data.size() - written);
+        if (result < 0)
+            return -1;
+        written += result;
+    }
+    return 0;
+}
+
+/*
+ * Serves the requests of one connection. The requests are answered by the pool,
+ * while a writer sends the answers in the order of the requests.
+ */
+int server_serve_stream(QueryServer &server, int in_fd, int out_fd)
+{
+    mutex pending_mutex;
+    condition_variable changed;
+    deque<future<string>> pending;
+    bool reading = true;
+    atomic<bool> failed(false);
+
+    thread writer([&]() {
+        while (true)
+        {
+            future<string> answer;
+            {
+                unique_lock<mutex> lock(pending_mutex);
+                changed.wait(lock, [&]() { return !pending.empty() || !reading; });
+                if (pending.empty())
+                    return;
+                answer = std::move(pending.front());
+                pending.pop_front();
+            }
+            changed.notify_all();
+            if (!failed && server_write_all(out_fd, answer.get()) != 0)
+                failed = true; // The other side is gone, the remaining answers are dropped.
+        }
+    });
+
+    string buffer;
+    char chunk[1 << 16];
+    bool quit = false;
+    while (!quit && !failed)
+    {
+        ssize_t length = read(in_fd, chunk, sizeof(chunk));
+        if (length <= 0)
+            break;
+        buffer.append(chunk, length);
+        size_t line_start = 0, line_end;
+        while ((line_end = buffer.find('\n', line_start)) != string::npos)
+        {
+            string line = buffer.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty())
+                continue;
+            if (line == "quit")
+            {
+                quit = true;
+                break;
+            }
+            unique_lock<mutex> lock(pending_mutex);
+            changed.wait(lock, [&]() { return pending.size() < SERVER_MAX_PENDING; });
+            pending.push_back(server.pool.submit([&server, line]() -> string {
+                try {
+                    return server_handle_request(server, line);
+                }
+                catch (const exception &e) { // Answered here, the writer must not see the exception.
+                    return string("ERR ") + e.what() + "\n";
+                }
+                catch (...) {
+                    return "ERR internal error\n";
+                }
+            }));
+            lock.unlock();
+            changed.notify_all();
+        }
+        buffer.erase(0, line_start);
+    }
+
+    {
+        lock_guard<mutex> lock(pending_mutex);
+        reading = false;
+    }
+    changed.notify_all();
+    writer.join();
+    return failed ? -1 : 0;
+}
+
+/*
+ * Accepts connections until the socket fails. Each connection is read by its own thread, the queries run on the pool.
+ * Before returning, the open connections are shut down and their threads are waited for, as they use the server.
+ */
+int server_serve_socket(QueryServer &server, const char *socket_path)
+{
+    signal(SIGPIPE, SIG_IGN); // A closed connection is reported by write instead.
+    sockaddr_un address{};
+    if (strlen(socket_path) >= sizeof(address.sun_path))
+        return -1;
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return -1;
+    unlink(socket_path);
+    if (bind(listener, (sockaddr *) &address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+    {
+        close(listener);
+        return -1;
+    }
+
+    mutex connections_mutex;
+    condition_variable connection_closed;
+    set<int> connections;
+    while (true)
+    {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        lock_guard<mutex> lock(connections_mutex);
+        connections.insert(connection);
+        thread([&server, &connections_mutex, &connection_closed, &connections, connection]() {
+            server_serve_stream(server, connection, connection);
+            lock_guard<mutex> lock(connections_mutex); // Held until the end, so the waiting frame outlives this thread.
+            connections.erase(connection);
+            close(connection);
+            connection_closed.notify_all();
+        }).detach();
+    }
+    {
+        unique_lock<mutex> lock(connections_mutex);
+        for (int connection : connections)
+            shutdown(connection, SHUT_RDWR); // Ends their reads and writes, the threads then finish.
+        connection_closed.wait(lock, [&]() { return connections.empty(); });
+    }
+    close(listener);
+    unlink(socket_path);
+    return -1;
+}
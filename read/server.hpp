@@ -0,0 +1,52 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_SERVER_HPP
+#define HYPERCSA_SERVER_HPP
+
+#include <string>
+
+#include "type_definitions.hpp"
+#include "thread_pool.hpp"
+#include "read.hpp"
+
+#define SERVER_MAX_PENDING 1024 // Requests of one connection that wait for their answer, before reading is paused.
+
+/*
+ * Line protocol, one request per line, nodes are comma-separated:
+ *   exact [nodes]            -> "[k]" and the k matching edges, one per line
+ *   contains [nodes]         -> the same for all edges that contain the nodes, nodes marked with '!' must not be
+ *                               contained, e.g. "contains 1,2,!7"
+ *   subset [nodes]           -> the same for all edges whose nodes are all in the list
+ *   overlap [k] [nodes]      -> the same for all edges that share at least k of the nodes
+ *   prefix [nodes]           -> the same for all edges whose smallest nodes are the list
+ *   range [a],[b]            -> the same for all edges whose nodes all lie in [a, b]
+ *   similar [k] [nodes]      -> "[m]" and the m <= k edges with the highest Jaccard similarity to the nodes, one
+ *                               per line as "[id] [similarity] [nodes]", best first
+ *   neighbors [k] [node]     -> "[m]" and the m nodes that share most edges with the node as "[node] [count]", all
+ *                               if k is 0
+ *   count exact [nodes]      -> "[k]"
+ *   count contains [nodes]   -> "[k]"
+ *   count subset [nodes]     -> "[k]"
+ *   count overlap [k] [nodes] -> "[k]"
+ *   count prefix [nodes]     -> "[k]"
+ *   count range [a],[b]      -> "[k]"
+ *   quit                     -> closes the connection
+ * Malformed requests, including text after the last argument, and requests that fail are answered with "ERR [reason]".
+ * The answers of a connection keep the order of its requests.
+ */
+class QueryServer {
+public:
+    CompressedHyperGraph graph; // Only read while serving, so the workers share it.
+    PreparedHyperGraph prepared;
+    ThreadPool pool;
+
+    QueryServer(CompressedHyperGraph g, unsigned threads);
+};
+
+std::string server_handle_request(QueryServer& server, const std::string& request);
+int server_serve_stream(QueryServer& server, int in_fd, int out_fd);
+int server_serve_socket(QueryServer& server, const char *socket_path);
+
+#endif //HYPERCSA_SERVER_HPP
@@ -0,0 +1,84 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "snapshot.hpp"
+
+#include "modify.hpp"
+
+using namespace std;
+
+GraphVersion snapshot_pin(SnapshotHyperGraph &sgraph)
+{
+    return atomic_load(&sgraph.current);
+}
+
+uint64_t snapshot_version(SnapshotHyperGraph &sgraph)
+{
+    return sgraph.version.load();
+}
+
+EdgeList snapshot_query(SnapshotHyperGraph &sgraph, Edge query, int type)
+{
+    GraphVersion pinned = snapshot_pin(sgraph);
+    return ::query(pinned->prepared, query, type);
+}
+
+/*
+ * Writes the modification of the current version to a new graph and publishes it with fresh supports.
+ * If the modification fails, the new graph is dropped and the current version stays untouched.
+ */
+int snapshot_update(SnapshotHyperGraph &sgraph,
+                    const function<int(const CompressedHyperGraph &, CompressedHyperGraph &)> &modification)
+{
+    lock_guard<mutex> lock(sgraph.writer);
+    GraphVersion pinned = atomic_load(&sgraph.current);
+    CompressedHyperGraph next({}, {});
+    try {
+        if (modification(pinned->graph, next) != 0)
+            return -1;
+    }
+    catch (int) { // A node would lose its last position.
+        return -1;
+    }
+    atomic_store(&sgraph.current, make_shared<SnapshotVersion>(std::move(next)));
+    sgraph.version++;
+    return 0;
+}
+
+int snapshot_insert_edge(SnapshotHyperGraph &sgraph, Edge edge)
+{
+    return snapshot_update(sgraph, [&](const CompressedHyperGraph &g, CompressedHyperGraph &next) {
+        return modify_insert_edge(g, next, edge);
+    });
+}
+
+int snapshot_delete_edge(SnapshotHyperGraph &sgraph, Edge edge)
+{
+    return snapshot_update(sgraph, [&](const CompressedHyperGraph &g, CompressedHyperGraph &next) {
+        Index pos = modify_find_edge(g, edge);
+        if (pos == (Index) -1)
+            return -1;
+        return modify_delete_edge(g, next, pos);
+    });
+}
+
+int snapshot_insert_node_to_edge(SnapshotHyperGraph &sgraph, Edge edge, Node node)
+{
+    return snapshot_update(sgraph, [&](const CompressedHyperGraph &g, CompressedHyperGraph &next) {
+        Index pos = modify_find_edge(g, edge);
+        if (pos == (Index) -1)
+            return -1;
+        return modify_insert_node_to_edge(g, next, pos, node);
+    });
+}
+
+int snapshot_delete_node_from_edge(SnapshotHyperGraph &sgraph, Edge edge, Node node)
+{
+    return snapshot_update(sgraph, [&](const CompressedHyperGraph &g, CompressedHyperGraph &next) {
+        Index pos = modify_find_edge(g, edge);
+        if (pos == (Index) -1)
+            return -1;
+        return modify_delete_node_from_edge(g, next, pos, node);
+    });
+}
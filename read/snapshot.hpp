@@ -0,0 +1,58 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_SNAPSHOT_HPP
+#define HYPERCSA_SNAPSHOT_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "type_definitions.hpp"
+#include "read.hpp"
+
+// A published graph with the supports of its queries. It is never modified again, so readers share the supports.
+class SnapshotVersion {
+public:
+    CompressedHyperGraph graph;
+    PreparedHyperGraph prepared; // Refers to graph, so a version is neither copied nor moved.
+
+    explicit SnapshotVersion(CompressedHyperGraph g) : graph(std::move(g)), prepared(graph) {}
+    SnapshotVersion(const SnapshotVersion&) = delete;
+    SnapshotVersion& operator=(const SnapshotVersion&) = delete;
+};
+
+typedef std::shared_ptr<SnapshotVersion> GraphVersion;
+
+/*
+ * Copy-on-write versions of a compressed graph.
+ * Readers pin the current version and query it without any lock.
+ * Writers build the next version from the output of the modification and publish it with an atomic swap, so a reader
+ * never sees a half-modified graph.
+ * A version is freed when the last reader drops its pin.
+ */
+class SnapshotHyperGraph {
+public:
+    GraphVersion current; // Only accessed with std::atomic_load and std::atomic_store.
+    std::atomic<uint64_t> version;
+    std::mutex writer; // Writers are serialized, so no update is lost.
+
+    explicit SnapshotHyperGraph(CompressedHyperGraph g)
+            : current(std::make_shared<SnapshotVersion>(std::move(g))), version(0) {}
+};
+
+GraphVersion snapshot_pin(SnapshotHyperGraph& sgraph);
+uint64_t snapshot_version(SnapshotHyperGraph& sgraph);
+EdgeList snapshot_query(SnapshotHyperGraph& sgraph, Edge query, int type);
+
+int snapshot_update(SnapshotHyperGraph& sgraph,
+                    const std::function<int(const CompressedHyperGraph&, CompressedHyperGraph&)>& modification);
+int snapshot_insert_edge(SnapshotHyperGraph& sgraph, Edge edge);
+// Positions are only valid within one version, so the updates address edges by their nodes.
+int snapshot_delete_edge(SnapshotHyperGraph& sgraph, Edge edge);
+int snapshot_insert_node_to_edge(SnapshotHyperGraph& sgraph, Edge edge, Node node);
+int snapshot_delete_node_from_edge(SnapshotHyperGraph& sgraph, Edge edge, Node node);
+
+#endif //HYPERCSA_SNAPSHOT_HPP
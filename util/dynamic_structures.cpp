@@ -0,0 +1,623 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "dynamic_structures.hpp"
+
+#include <random>
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+using Block = DynamicBitVector::Block;
+
+#define BLOCK_BITS (DYNAMIC_BLOCK_WORDS * 64)
+
+///////////// Blocks /////////////////////
+
+static uint32_t random_priority()
+{
+    static thread_local mt19937 generator(0x9e3779b9);
+    return generator();
+}
+
+static Block *block_new()
+{
+    auto *b = new Block();
+    fill(b->words, b->words + DYNAMIC_BLOCK_WORDS, 0);
+    b->bits = 0;
+    b->ones = 0;
+    b->priority = random_priority();
+    b->subtree_bits = 0;
+    b->subtree_ones = 0;
+    b->left = nullptr;
+    b->right = nullptr;
+    return b;
+}
+
+static uint64_t subtree_bits(const Block *b) { return b ? b->subtree_bits : 0; }
+static uint64_t subtree_ones(const Block *b) { return b ? b->subtree_ones : 0; }
+
+static void block_update(Block *b)
+{
+    b->subtree_bits = b->bits + subtree_bits(b->left) + subtree_bits(b->right);
+    b->subtree_ones = b->ones + subtree_ones(b->left) + subtree_ones(b->right);
+}
+
+static bool block_get(const Block *b, uint32_t j)
+{
+    return (b->words[j >> 6] >> (j & 63)) & 1;
+}
+
+static uint32_t block_rank(const Block *b, uint32_t j)
+{
+    uint32_t r = 0;
+    for (uint32_t w = 0; w < (j >> 6); w++)
+        r += __builtin_popcountll(b->words[w]);
+    if (j & 63)
+        r += __builtin_popcountll(b->words[j >> 6] & ((1ULL << (j & 63)) - 1));
+    return r;
+}
+
+static uint32_t block_select(const Block *b, uint32_t k, bool bit)
+{
+    for (uint32_t w = 0; w <= ((b->bits - 1) >> 6); w++)
+    {
+        uint64_t word = bit ? b->words[w] : ~b->words[w];
+        uint32_t valid = min<uint32_t>(64, b->bits - (w << 6));
+        if (valid < 64)
+            word &= (1ULL << valid) - 1;
+        uint32_t count = __builtin_popcountll(word);
+        if (k <= count)
+        {
+            for (; k > 1; k--)
+                word &= word - 1; // Clear lowest set bit.
+            return (w << 6) + __builtin_ctzll(word);
+        }
+        k -= count;
+    }
+    return b->bits;
+}
+
+static void block_insert(Block *b, uint32_t j, bool bit)
+{
+    uint32_t w = j >> 6, offset = j & 63;
+    for (uint32_t k = b->bits >> 6; k > w; k--)
+        b->words[k] = (b->words[k] << 1) | (b->words[k - 1] >> 63);
+    uint64_t low = offset ? (1ULL << offset) - 1 : 0;
+    uint64_t x = b->words[w];
+    b->words[w] = (x & low) | ((x & ~low) << 1) | ((uint64_t) bit << offset);
+    b->bits++;
+    b->ones += bit;
+}
+
+static void block_erase(Block *b, uint32_t j)
+{
+    uint32_t w = j >> 6, offset = j & 63, last = (b->bits - 1) >> 6;
+    b->ones -= block_get(b, j);
+    uint64_t low = offset ? (1ULL << offset) - 1 : 0;
+    uint64_t x = b->words[w];
+    b->words[w] = (x & low) | ((x >> 1) & ~low);
+    for (uint32_t k = w; k < last; k++)
+    {
+        b->words[k] |= (b->words[k + 1] & 1) << 63;
+        b->words[k + 1] >>= 1;
+    }
+    b->bits--;
+}
+
+///////////// Treap of blocks /////////////////////
+
+static Block *treap_merge(Block *a, Block *b)
+{
+    if (!a || !b)
+        return a ? a : b;
+    if (a->priority > b->priority)
+    {
+        a->right = treap_merge(a->right, b);
+        block_update(a);
+        return a;
+    }
+    b->left = treap_merge(a, b->left);
+    block_update(b);
+    return b;
+}
+
+// Splits at bit position k, which has to be a block boundary.
+static void treap_split(Block *t, uint64_t k, Block *&l, Block *&r)
+{
+    if (!t)
+    {
+        l = r = nullptr;
+        return;
+    }
+    uint64_t left_bits = subtree_bits(t->left);
+    if (k <= left_bits)
+    {
+        treap_split(t->left, k, l, t->left);
+        r = t;
+    }
+    else
+    {
+        treap_split(t->right, k - left_bits - t->bits, t->right, r);
+        l = t;
+    }
+    block_update(t);
+}
+
+static Block *treap_copy(const Block *b)
+{
+    if (!b)
+        return nullptr;
+    auto *c = new Block(*b);
+    c->left = treap_copy(b->left);
+    c->right = treap_copy(b->right);
+    return c;
+}
+
+static void treap_free(Block *b)
+{
+    if (!b)
+        return;
+    treap_free(b->left);
+    treap_free(b->right);
+    delete b;
+}
+
+static Block *treap_build(vector<Block *> &list, size_t from, size_t to)
+{
+    if (from >= to)
+        return nullptr;
+    size_t middle = from + (to - from) / 2;
+    Block *b = list[middle];
+    b->left = treap_build(list, from, middle);
+    b->right = treap_build(list, middle + 1, to);
+    block_update(b);
+    return b;
+}
+
+///////////// DynamicBitVector /////////////////////
+
+DynamicBitVector::DynamicBitVector() : root(nullptr), blocks(0) {}
+
+DynamicBitVector::DynamicBitVector(const sdsl::bit_vector &bv) : root(nullptr), blocks(0)
+{
+    // Blocks are filled half, so that inserts do not split them immediately.
+    vector<Block *> list;
+    for (uint64_t i = 0; i < bv.size(); i++)
+    {
+        if (i % (BLOCK_BITS / 2) == 0)
+            list.push_back(block_new());
+        block_insert(list.back(), list.back()->bits, bv[i]);
+    }
+    blocks = list.size();
+    root = treap_build(list, 0, list.size());
+
+    // Assign the priorities in breadth-first order, such that the balanced tree is a valid treap.
+    vector<uint32_t> priorities(list.size());
+    for (auto &p : priorities)
+        p = random_priority();
+    sort(priorities.begin(), priorities.end(), greater<>());
+    queue<Block *> bfs;
+    if (root)
+        bfs.push(root);
+    size_t next = 0;
+    while (!bfs.empty())
+    {
+        Block *b = bfs.front();
+        bfs.pop();
+        b->priority = priorities[next++];
+        if (b->left)
+            bfs.push(b->left);
+        if (b->right)
+            bfs.push(b->right);
+    }
+}
+
+DynamicBitVector::DynamicBitVector(const DynamicBitVector &other)
+        : root(treap_copy(other.root)), blocks(other.blocks) {}
+
+DynamicBitVector::DynamicBitVector(DynamicBitVector &&other) noexcept
+        : root(other.root), blocks(other.blocks)
+{
+    other.root = nullptr;
+    other.blocks = 0;
+}
+
+DynamicBitVector &DynamicBitVector::operator=(DynamicBitVector other)
+{
+    swap(root, other.root);
+    swap(blocks, other.blocks);
+    return *this;
+}
+
+DynamicBitVector::~DynamicBitVector()
+{
+    treap_free(root);
+}
+
+uint64_t DynamicBitVector::size() const
+{
+    return subtree_bits(root);
+}
+
+uint64_t DynamicBitVector::ones() const
+{
+    return subtree_ones(root);
+}
+
+bool DynamicBitVector::operator[](uint64_t i) const
+{
+    const Block *t = root;
+    while (t)
+    {
+        uint64_t left_bits = subtree_bits(t->left);
+        if (i < left_bits)
+            t = t->left;
+        else if (i < left_bits + t->bits)
+            return block_get(t, i - left_bits);
+        else
+        {
+            i -= left_bits + t->bits;
+            t = t->right;
+        }
+    }
+    return false;
+}
+
+uint64_t DynamicBitVector::rank1(uint64_t i) const
+{
+    uint64_t r = 0;
+    const Block *t = root;
+    while (t)
+    {
+        uint64_t left_bits = subtree_bits(t->left);
+        if (i < left_bits)
+        {
+            t = t->left;
+            continue;
+        }
+        r += subtree_ones(t->left);
+        i -= left_bits;
+        if (i < t->bits)
+            return r + block_rank(t, i);
+        r += t->ones;
+        i -= t->bits;
+        t = t->right;
+    }
+    return r;
+}
+
+uint64_t DynamicBitVector::rank0(uint64_t i) const
+{
+    return i - rank1(i);
+}
+
+uint64_t DynamicBitVector::select1(uint64_t k) const
+{
+    uint64_t offset = 0;
+    const Block *t = root;
+    while (t)
+    {
+        uint64_t left_ones = subtree_ones(t->left);
+        if (k <= left_ones)
+        {
+            t = t->left;
+            continue;
+        }
+        k -= left_ones;
+        offset += subtree_bits(t->left);
+        if (k <= t->ones)
+            return offset + block_select(t, k, true);
+        k -= t->ones;
+        offset += t->bits;
+        t = t->right;
+    }
+    return offset;
+}
+
+uint64_t DynamicBitVector::select0(uint64_t k) const
+{
+    uint64_t offset = 0;
+    const Block *t = root;
+    while (t)
+    {
+        uint64_t left_zeros = subtree_bits(t->left) - subtree_ones(t->left);
+        if (k <= left_zeros)
+        {
+            t = t->left;
+            continue;
+        }
+        k -= left_zeros;
+        offset += subtree_bits(t->left);
+        if (k <= t->bits - t->ones)
+            return offset + block_select(t, k, false);
+        k -= t->bits - t->ones;
+        offset += t->bits;
+        t = t->right;
+    }
+    return offset;
+}
+
+void DynamicBitVector::insert(uint64_t i, bool bit)
+{
+    if (!root)
+    {
+        root = block_new();
+        blocks = 1;
+    }
+    vector<Block *> path;
+    uint64_t offset = 0, j = i;
+    Block *t = root;
+    while (true)
+    {
+        path.push_back(t);
+        uint64_t left_bits = subtree_bits(t->left);
+        if (j < left_bits)
+            t = t->left;
+        else if (j <= left_bits + t->bits)
+        {
+            offset += left_bits;
+            j -= left_bits;
+            break;
+        }
+        else
+        {
+            offset += left_bits + t->bits;
+            j -= left_bits + t->bits;
+            t = t->right;
+        }
+    }
+
+    if (t->bits == BLOCK_BITS)
+    { // Split the full block and insert the upper half as a new block right after it.
+        Block *upper = block_new();
+        copy(t->words + DYNAMIC_BLOCK_WORDS / 2, t->words + DYNAMIC_BLOCK_WORDS, upper->words);
+        fill(t->words + DYNAMIC_BLOCK_WORDS / 2, t->words + DYNAMIC_BLOCK_WORDS, 0);
+        upper->bits = BLOCK_BITS / 2;
+        upper->ones = block_rank(upper, upper->bits);
+        t->bits = BLOCK_BITS / 2;
+        t->ones = block_rank(t, t->bits);
+        for (auto it = path.rbegin(); it != path.rend(); it++)
+            block_update(*it);
+        block_update(upper);
+        Block *l, *r;
+        treap_split(root, offset + t->bits, l, r);
+        root = treap_merge(treap_merge(l, upper), r);
+        blocks++;
+        insert(i, bit);
+        return;
+    }
+
+    block_insert(t, j, bit);
+    for (Block *b : path)
+    {
+        b->subtree_bits++;
+        b->subtree_ones += bit;
+    }
+}
+
+void DynamicBitVector::erase(uint64_t i)
+{
+    vector<Block *> path;
+    Block *t = root;
+    while (t)
+    {
+        path.push_back(t);
+        uint64_t left_bits = subtree_bits(t->left);
+        if (i < left_bits)
+            t = t->left;
+        else if (i < left_bits + t->bits)
+        {
+            i -= left_bits;
+            break;
+        }
+        else
+        {
+            i -= left_bits + t->bits;
+            t = t->right;
+        }
+    }
+    if (!t)
+        return;
+
+    bool bit = block_get(t, i);
+    block_erase(t, i);
+    for (Block *b : path)
+    {
+        b->subtree_bits--;
+        b->subtree_ones -= bit;
+    }
+
+    if (t->bits == 0)
+    { // Remove the empty block.
+        Block *replacement = treap_merge(t->left, t->right);
+        if (path.size() == 1)
+            root = replacement;
+        else if (path[path.size() - 2]->left == t)
+            path[path.size() - 2]->left = replacement;
+        else
+            path[path.size() - 2]->right = replacement;
+        delete t;
+        blocks--;
+    }
+}
+
+sdsl::bit_vector DynamicBitVector::to_bit_vector() const
+{
+    sdsl::bit_vector bv(size(), 0);
+    uint64_t pos = 0;
+    vector<const Block *> stack;
+    const Block *t = root;
+    while (t || !stack.empty())
+    { // In-order traversal.
+        while (t)
+        {
+            stack.push_back(t);
+            t = t->left;
+        }
+        t = stack.back();
+        stack.pop_back();
+        for (uint32_t j = 0; j < t->bits; j++)
+            bv[pos++] = block_get(t, j);
+        t = t->right;
+    }
+    return bv;
+}
+
+uint64_t DynamicBitVector::size_in_bytes() const
+{
+    return sizeof(DynamicBitVector) + blocks * sizeof(Block);
+}
+
+///////////// DynamicSequence /////////////////////
+
+static uint8_t width_of(uint64_t value)
+{
+    uint8_t width = 1;
+    while (width < 64 && (value >> width) != 0)
+        width++;
+    return width;
+}
+
+DynamicSequence::DynamicSequence() : levels(1), zeros(1, 0) {}
+
+DynamicSequence::DynamicSequence(const vector<uint64_t> &values)
+{
+    uint64_t max_value = 0;
+    for (uint64_t v : values)
+        max_value = max(max_value, v);
+    uint8_t width = width_of(max_value);
+
+    // Wavelet matrix: each level is stably partitioned by the bit of the previous level.
+    vector<uint64_t> current = values, next(values.size());
+    for (uint8_t l = 0; l < width; l++)
+    {
+        uint8_t shift = width - 1 - l;
+        sdsl::bit_vector bits(current.size(), 0);
+        uint64_t z = 0;
+        for (uint64_t i = 0; i < current.size(); i++)
+        {
+            bits[i] = (current[i] >> shift) & 1;
+            z += !bits[i];
+        }
+        uint64_t zero_pos = 0, one_pos = z;
+        for (uint64_t i = 0; i < current.size(); i++)
+            next[bits[i] ? one_pos++ : zero_pos++] = current[i];
+        levels.emplace_back(bits);
+        zeros.push_back(z);
+        swap(current, next);
+    }
+}
+
+uint64_t DynamicSequence::size() const
+{
+    return levels[0].size();
+}
+
+uint64_t DynamicSequence::operator[](uint64_t i) const
+{
+    uint64_t c = 0;
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        bool bit = levels[l][i];
+        c = (c << 1) | bit;
+        i = bit ? zeros[l] + levels[l].rank1(i) : levels[l].rank0(i);
+    }
+    return c;
+}
+
+uint64_t DynamicSequence::rank(uint64_t c, uint64_t i) const
+{
+    if (width_of(c) > levels.size())
+        return 0;
+    uint64_t p = 0;
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        if ((c >> (levels.size() - 1 - l)) & 1)
+        {
+            p = zeros[l] + levels[l].rank1(p);
+            i = zeros[l] + levels[l].rank1(i);
+        }
+        else
+        {
+            p = levels[l].rank0(p);
+            i = levels[l].rank0(i);
+        }
+    }
+    return i - p;
+}
+
+uint64_t DynamicSequence::select(uint64_t c, uint64_t k) const
+{
+    uint64_t p = 0;
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        if ((c >> (levels.size() - 1 - l)) & 1)
+            p = zeros[l] + levels[l].rank1(p);
+        else
+            p = levels[l].rank0(p);
+    }
+    uint64_t pos = p + k - 1;
+    for (size_t l = levels.size(); l-- > 0;)
+    {
+        if ((c >> (levels.size() - 1 - l)) & 1)
+            pos = levels[l].select1(pos - zeros[l] + 1);
+        else
+            pos = levels[l].select0(pos + 1);
+    }
+    return pos;
+}
+
+void DynamicSequence::insert(uint64_t i, uint64_t c)
+{
+    if (width_of(c) > levels.size())
+        rebuild(width_of(c));
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        bool bit = (c >> (levels.size() - 1 - l)) & 1;
+        levels[l].insert(i, bit);
+        if (bit)
+            i = zeros[l] + levels[l].rank1(i);
+        else
+        {
+            i = levels[l].rank0(i);
+            zeros[l]++;
+        }
+    }
+}
+
+void DynamicSequence::erase(uint64_t i)
+{
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        bool bit = levels[l][i];
+        uint64_t next = bit ? zeros[l] + levels[l].rank1(i) : levels[l].rank0(i);
+        levels[l].erase(i);
+        if (!bit)
+            zeros[l]--;
+        i = next;
+    }
+}
+
+uint64_t DynamicSequence::size_in_bytes() const
+{
+    uint64_t bytes = sizeof(DynamicSequence) + zeros.size() * sizeof(uint64_t);
+    for (const auto &level : levels)
+        bytes += level.size_in_bytes();
+    return bytes;
+}
+
+void DynamicSequence::rebuild(uint8_t width)
+{
+    vector<uint64_t> values(size());
+    for (uint64_t i = 0; i < values.size(); i++)
+        values[i] = (*this)[i];
+    *this = DynamicSequence(values);
+    // Prepend levels of zeros to reach the requested width.
+    while (levels.size() < width)
+    {
+        levels.insert(levels.begin(), DynamicBitVector(sdsl::bit_vector(values.size(), 0)));
+        zeros.insert(zeros.begin(), values.size());
+    }
+}
@@ -0,0 +1,96 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_DYNAMIC_STRUCTURES_HPP
+#define HYPERCSA_DYNAMIC_STRUCTURES_HPP
+
+#include <cstdint>
+#include <vector>
+#include <sdsl/int_vector.hpp>
+
+#define DYNAMIC_BLOCK_WORDS 32 // Each block holds at most 2048 bits.
+
+/*
+ * Bitvector with insert and erase. The bits are stored in blocks, which are the nodes of a treap ordered by position.
+ * Each node counts the bits and ones of its subtree, so access, rank, select, insert and erase touch O(log n) blocks.
+ */
+class DynamicBitVector {
+public:
+    struct Block {
+        uint64_t words[DYNAMIC_BLOCK_WORDS];
+        uint32_t bits;
+        uint32_t ones;
+        uint32_t priority;
+        uint64_t subtree_bits;
+        uint64_t subtree_ones;
+        Block *left;
+        Block *right;
+    };
+
+    DynamicBitVector();
+    explicit DynamicBitVector(const sdsl::bit_vector &bv);
+    DynamicBitVector(const DynamicBitVector &other);
+    DynamicBitVector(DynamicBitVector &&other) noexcept;
+    DynamicBitVector &operator=(DynamicBitVector other);
+    ~DynamicBitVector();
+
+    uint64_t size() const;
+    uint64_t ones() const;
+    bool operator[](uint64_t i) const;
+    uint64_t rank1(uint64_t i) const; // Ones in [0, i).
+    uint64_t rank0(uint64_t i) const;
+    uint64_t select1(uint64_t k) const; // Position of the k-th one, 1-based like sdsl.
+    uint64_t select0(uint64_t k) const;
+    void insert(uint64_t i, bool bit);
+    void erase(uint64_t i);
+    sdsl::bit_vector to_bit_vector() const;
+    uint64_t size_in_bytes() const;
+
+private:
+    Block *root;
+    uint64_t blocks;
+};
+
+/*
+ * Sequence over integers with insert and erase, stored as wavelet matrix on DynamicBitVectors.
+ * The width grows when a larger symbol is inserted.
+ */
+class DynamicSequence {
+public:
+    DynamicSequence();
+    explicit DynamicSequence(const std::vector<uint64_t> &values);
+
+    uint64_t size() const;
+    uint64_t operator[](uint64_t i) const;
+    uint64_t rank(uint64_t c, uint64_t i) const; // Occurrences of c in [0, i).
+    uint64_t select(uint64_t c, uint64_t k) const; // Position of the k-th occurrence of c, 1-based.
+    void insert(uint64_t i, uint64_t c);
+    void erase(uint64_t i);
+    uint64_t size_in_bytes() const;
+
+private:
+    std::vector<DynamicBitVector> levels;
+    std::vector<uint64_t> zeros;
+
+    void rebuild(uint8_t width);
+};
+
+// Adapters with the interface of the sdsl supports, so the query code can be shared.
+class DynamicRankSupport {
+    const DynamicBitVector *bv;
+public:
+    explicit DynamicRankSupport(const DynamicBitVector *v) : bv(v) {}
+    uint64_t rank(uint64_t i) const { return bv->rank1(i); }
+    uint64_t operator()(uint64_t i) const { return bv->rank1(i); }
+};
+
+class DynamicSelectSupport {
+    const DynamicBitVector *bv;
+public:
+    explicit DynamicSelectSupport(const DynamicBitVector *v) : bv(v) {}
+    uint64_t select(uint64_t k) const { return bv->select1(k); }
+    uint64_t operator()(uint64_t k) const { return bv->select1(k); }
+};
+
+#endif //HYPERCSA_DYNAMIC_STRUCTURES_HPP
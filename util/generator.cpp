@@ -0,0 +1,237 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "generator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <string>
+
+#include <sdsl/rank_support.hpp>
+
+#include "thread_pool.hpp"
+
+using namespace std;
+using namespace sdsl;
+
+/*
+ * Draws k in [1, n] with probability proportional to k^-exponent in O(1) time and memory,
+ * by rejection-inversion (Hörmann and Derflinger, 1996).
+ */
+class ZipfSampler {
+    uint64_t n;
+    double exponent;
+    double h_integral_x1, h_integral_n, s;
+
+    static double helper1(double x) { return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x)); }
+    static double helper2(double x) { return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x)); }
+    double h(double x) const { return exp(-exponent * log(x)); }
+    double h_integral(double x) const { double log_x = log(x); return helper2((1 - exponent) * log_x) * log_x; }
+    double h_integral_inverse(double x) const {
+        double t = max(-1.0, x * (1 - exponent));
+        return exp(helper1(t) * x);
+    }
+
+public:
+    ZipfSampler(uint64_t elements, double e) : n(elements), exponent(e) {
+        h_integral_x1 = h_integral(1.5) - 1;
+        h_integral_n = h_integral(n + 0.5);
+        s = 2 - h_integral_inverse(h_integral(2.5) - h(2));
+    }
+
+    template<class R>
+    uint64_t operator()(R &random) const {
+        uniform_real_distribution<double> uniform(0, 1);
+        while (true)
+        {
+            double u = h_integral_n + uniform(random) * (h_integral_x1 - h_integral_n);
+            double x = h_integral_inverse(u);
+            uint64_t k = (uint64_t) max(1.0, min((double) n, floor(x + 0.5)));
+            if (k - x <= s || u >= h_integral(k + 0.5) - h(k))
+                return k;
+        }
+    }
+};
+
+// Draws nodes and edge sizes of one chunk. The ranks of the power law are spread over the node ids.
+class ChunkGenerator {
+    const GeneratorConfig &config;
+    mt19937_64 random;
+    ZipfSampler nodes_sampler, size_sampler;
+    uint64_t spread;
+
+public:
+    ChunkGenerator(const GeneratorConfig &c, uint64_t chunk)
+            : config(c), random(c.seed * 0x9e3779b97f4a7c15ULL + chunk),
+              nodes_sampler(max<uint64_t>(c.nodes, 1), c.degree_exponent > 0 ? c.degree_exponent : 1),
+              size_sampler(c.max_size - c.min_size + 1, c.size_exponent > 0 ? c.size_exponent : 1)
+    {
+        spread = 0x9e3779b97f4a7c15ULL % max<uint64_t>(c.nodes, 1);
+        while (gcd(spread, c.nodes) != 1) // A factor coprime to the node count permutes the ranks.
+            spread++;
+    }
+
+    Node node() {
+        if (config.degree_exponent <= 0)
+            return random() % config.nodes;
+        return (__uint128_t) (nodes_sampler(random) - 1) * spread % config.nodes;
+    }
+
+    uint64_t size() {
+        if (config.size_distribution == SIZE_POWER_LAW)
+            return config.min_size + size_sampler(random) - 1;
+        return config.min_size + random() % (config.max_size - config.min_size + 1);
+    }
+
+    // Calls emit for each edge of the chunk with its sorted nodes.
+    template<class F>
+    void edges(uint64_t count, F emit) {
+        deque<vector<Node>> earlier; // A window of earlier edges for the duplicates.
+        uniform_real_distribution<double> uniform(0, 1);
+        vector<Node> edge;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (!earlier.empty() && uniform(random) < config.duplicate_rate)
+                edge = earlier[random() % earlier.size()];
+            else
+            {
+                uint64_t k = min(size(), config.nodes);
+                edge.clear();
+                for (uint64_t attempts = 0; edge.size() < k; attempts++)
+                {
+                    Node v = attempts < 32 * k ? node() : random() % config.nodes; // Uniform, if the hubs are taken.
+                    if (find(edge.begin(), edge.end(), v) == edge.end())
+                        edge.push_back(v);
+                }
+                sort(edge.begin(), edge.end());
+            }
+            emit(edge);
+            if (config.duplicate_rate > 0)
+            {
+                earlier.push_back(edge);
+                if (earlier.size() > 1024)
+                    earlier.pop_front();
+            }
+        }
+    }
+};
+
+uint64_t generator_chunks(const GeneratorConfig &config)
+{
+    return (config.edges + GENERATOR_CHUNK_EDGES - 1) / GENERATOR_CHUNK_EDGES;
+}
+
+uint64_t generator_chunk_edges(const GeneratorConfig &config, uint64_t chunk)
+{
+    return min<uint64_t>(GENERATOR_CHUNK_EDGES, config.edges - chunk * GENERATOR_CHUNK_EDGES);
+}
+
+bool generator_valid(const GeneratorConfig &config)
+{
+    return config.nodes > 0 && config.min_size > 0 && config.min_size <= config.max_size
+           && config.duplicate_rate >= 0 && config.duplicate_rate <= 1;
+}
+
+// First pass: marks the nodes that occur in any edge. The chunks are generated in parallel.
+bit_vector generator_used_nodes(const GeneratorConfig &config)
+{
+    vector<atomic<uint64_t>> words((config.nodes + 63) / 64);
+    {
+        ThreadPool pool(config.threads);
+        for (uint64_t chunk = 0; chunk < generator_chunks(config); chunk++)
+        {
+            pool.submit([&config, &words, chunk]() {
+                ChunkGenerator generator(config, chunk);
+                generator.edges(generator_chunk_edges(config, chunk), [&words](const vector<Node> &edge) {
+                    for (Node v : edge)
+                        words[v / 64].fetch_or(1ULL << (v % 64), memory_order_relaxed);
+                });
+            });
+        }
+    } // Waits for all chunks.
+    bit_vector used(config.nodes, 0);
+    for (uint64_t v = 0; v < config.nodes; v++)
+        used[v] = (words[v / 64].load(memory_order_relaxed) >> (v % 64)) & 1;
+    return used;
+}
+
+HyperGraph generate_hypergraph(const GeneratorConfig &config)
+{
+    HyperGraph graph;
+    if (!generator_valid(config))
+        return graph;
+    bit_vector used = generator_used_nodes(config);
+    rank_support_v<1> rank_used(&used);
+
+    graph.edges.resize(config.edges);
+    {
+        ThreadPool pool(config.threads);
+        for (uint64_t chunk = 0; chunk < generator_chunks(config); chunk++)
+        {
+            pool.submit([&config, &graph, &rank_used, chunk]() {
+                ChunkGenerator generator(config, chunk);
+                uint64_t i = chunk * GENERATOR_CHUNK_EDGES;
+                generator.edges(generator_chunk_edges(config, chunk), [&](const vector<Node> &edge) {
+                    Edge e(edge.size());
+                    for (size_t j = 0; j < edge.size(); j++)
+                        e[j] = rank_used(edge[j]);
+                    graph.edges[i++] = std::move(e);
+                });
+            });
+        }
+    }
+    graph.edge_count = graph.edges.size();
+    return graph;
+}
+
+int generate_hypergraph_file(const GeneratorConfig &config, const char *output_file)
+{
+    if (!generator_valid(config))
+        return -1;
+    FILE *out = fopen(output_file, "w");
+    if (out == nullptr)
+        return -1;
+    bit_vector used = generator_used_nodes(config);
+    rank_support_v<1> rank_used(&used);
+
+    // Second pass: the chunks are formatted in parallel and written in their order.
+    ThreadPool pool(config.threads);
+    deque<future<string>> pending;
+    int result = 0;
+    auto write_front = [&]() {
+        string text = pending.front().get();
+        pending.pop_front();
+        if (fwrite(text.data(), 1, text.size(), out) != text.size())
+            result = -1;
+    };
+    for (uint64_t chunk = 0; chunk < generator_chunks(config); chunk++)
+    {
+        pending.push_back(pool.submit([&config, &rank_used, chunk]() {
+            string text;
+            ChunkGenerator generator(config, chunk);
+            generator.edges(generator_chunk_edges(config, chunk), [&](const vector<Node> &edge) {
+                for (size_t j = 0; j < edge.size(); j++)
+                {
+                    if (j > 0)
+                        text += ',';
+                    text += to_string(rank_used(edge[j]));
+                }
+                text += '\n';
+            });
+            return text;
+        }));
+        if (pending.size() >= 2 * pool.size()) // Bounds the memory of formatted chunks.
+            write_front();
+    }
+    while (!pending.empty())
+        write_front();
+    if (fclose(out) != 0)
+        result = -1;
+    return result;
+}
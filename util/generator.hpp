@@ -0,0 +1,43 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_GENERATOR_HPP
+#define HYPERCSA_GENERATOR_HPP
+
+#include <thread>
+
+#include "type_definitions.hpp"
+
+#define GENERATOR_CHUNK_EDGES 65536 // Edges of one chunk, each chunk has its own random generator.
+
+#define SIZE_UNIFORM 0
+#define SIZE_POWER_LAW 1
+
+/*
+ * Parameters of a synthetic hypergraph.
+ * The node degrees follow a power law with degree_exponent, 0 draws the nodes uniformly.
+ * The edge sizes are drawn from [min_size, max_size], uniformly or by a power law with size_exponent.
+ * With probability duplicate_rate, an edge copies an earlier edge of its chunk.
+ * Nodes that occur in no edge are removed and the others renumbered, as D requires consecutive nodes.
+ */
+class GeneratorConfig {
+public:
+    uint64_t nodes = 1000;
+    uint64_t edges = 10000;
+    uint64_t min_size = 1;
+    uint64_t max_size = 8;
+    int size_distribution = SIZE_UNIFORM;
+    double size_exponent = 2.0;
+    double degree_exponent = 0.0;
+    double duplicate_rate = 0.0;
+    uint64_t seed = 1;
+    unsigned threads = std::thread::hardware_concurrency();
+};
+
+// The result only depends on the config without threads, so it can be reproduced with any number of threads.
+HyperGraph generate_hypergraph(const GeneratorConfig& config);
+// Writes the graph in the input format of parse_graph, one edge per line with comma-separated nodes.
+int generate_hypergraph_file(const GeneratorConfig& config, const char *output_file);
+
+#endif //HYPERCSA_GENERATOR_HPP
@@ -0,0 +1,65 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#define SUB_BUCKETS (1ULL << HISTOGRAM_SUB_BUCKET_BITS)
+#define HALF_SUB_BUCKETS (SUB_BUCKETS / 2)
+
+LatencyHistogram::LatencyHistogram()
+        : counts(bucket(UINT64_MAX) + 1, 0) {}
+
+uint64_t LatencyHistogram::bucket(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+        return value;
+    uint64_t shift = 63 - __builtin_clzll(value) - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+    uint64_t mantissa = value >> shift; // In [HALF_SUB_BUCKETS, SUB_BUCKETS).
+    return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + (mantissa - HALF_SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::highest_in_bucket(uint64_t index)
+{
+    if (index < SUB_BUCKETS)
+        return index;
+    uint64_t shift = (index - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+    uint64_t mantissa = (index - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    counts[bucket(value)]++;
+    total++;
+    minimum = std::min(minimum, value);
+    maximum = std::max(maximum, value);
+    sum += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t i = 0; i < counts.size(); i++)
+        counts[i] += other.counts[i];
+    total += other.total;
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    sum += other.sum;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    if (total == 0)
+        return 0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t) std::ceil(p * total)), seen = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(highest_in_bucket(i), maximum);
+    }
+    return maximum;
+}
@@ -0,0 +1,39 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_HISTOGRAM_HPP
+#define HYPERCSA_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <vector>
+
+#define HISTOGRAM_SUB_BUCKET_BITS 7 // Values below 2^7 are exact, larger values keep 6 bits, i.e. less than 1.6% error.
+
+/*
+ * Histogram of latencies in the style of HdrHistogram: log-linear buckets over the whole uint64_t range,
+ * so recording is O(1), the memory is fixed (a few KB) and the percentiles have a bounded relative error.
+ */
+class LatencyHistogram {
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t minimum = UINT64_MAX;
+    uint64_t maximum = 0;
+    double sum = 0;
+
+    static uint64_t bucket(uint64_t value);
+    static uint64_t highest_in_bucket(uint64_t index);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total == 0 ? 0 : minimum; }
+    uint64_t max() const { return maximum; }
+    double mean() const { return total == 0 ? 0 : sum / total; }
+    uint64_t percentile(double p) const; // p in [0, 1], the highest value that is equivalent to the percentile.
+};
+
+#endif //HYPERCSA_HISTOGRAM_HPP
@@ -0,0 +1,43 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#include "thread_pool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned threads) : stopping(false)
+{
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        function<void()> job;
+        {
+            unique_lock<mutex> lock(jobs_mutex);
+            available.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return; // Stopping and nothing left to do.
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
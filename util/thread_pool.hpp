@@ -0,0 +1,51 @@
+//
+// Created by Enno Adler on 18.10.26.
+//
+
+#ifndef HYPERCSA_THREAD_POOL_HPP
+#define HYPERCSA_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed number of workers that run the submitted tasks in submission order.
+ * The destructor finishes all submitted tasks before it joins the workers.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    template<class F>
+    auto submit(F task) -> std::future<decltype(task())>
+    {
+        auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+        auto result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            jobs.emplace([packaged]() { (*packaged)(); });
+        }
+        available.notify_one();
+        return result;
+    }
+
+    unsigned size() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void work();
+};
+
+#endif //HYPERCSA_THREAD_POOL_HPP
@@ -10,8 +10,14 @@
 #include <sdsl/enc_vector.hpp>
 #include <utility>
 
+#include "dynamic_structures.hpp"
+
 #define EXACT 0
 #define CONTAIN 1
+#define SUBSET 2 // All edges whose nodes are in the query.
+#define OVERLAP 3 // All edges that share at least a threshold of the query nodes, 1 if not given.
+#define PREFIX 4 // All edges whose smallest nodes are the query nodes.
+#define RANGE 5 // All edges whose nodes are in [a, b], the query is {a, b}.
 
 typedef uint64_t Node;
 typedef uint64_t Index; // Used for any Position related values.
@@ -20,6 +26,25 @@ typedef std::vector<Edge> EdgeList;
 
 typedef sdsl::int_vector<64> LinearRepresentation;
 
+/*
+ * Edges in one flat buffer: the nodes of edge i are nodes[offsets[i]] to nodes[offsets[i+1]-1].
+ * Reusing the buffer with clear() keeps its capacity, so later queries do not allocate.
+ */
+template<class T>
+class FlatEdgeList {
+public:
+    std::vector<uint64_t> offsets;
+    std::vector<T> nodes;
+
+    FlatEdgeList() : offsets(1, 0) {}
+
+    size_t size() const { return offsets.size() - 1; }
+    void clear() {
+        offsets.assign(1, 0);
+        nodes.clear();
+    }
+};
+
 class HyperGraph {
 public:
     Index edge_count;
@@ -28,13 +53,152 @@ public:
     HyperGraph() : edge_count(0) {}
 };
 
+/*
+ * Marks the backward jump of each cycle of PSI, i.e. the positions i with PSI[i] <= i.
+ * Each edge has exactly one, at the position of its largest node, so the i-th 1 is the i-th edge.
+ */
+template<class P>
+sdsl::bit_vector edge_starts(const P& psi)
+{
+    sdsl::bit_vector e(psi.size(), 0);
+    for (Index i = 0; i < psi.size(); i++)
+        e[i] = psi[i] <= i;
+    return e;
+}
+
+// The stable ids of a new graph, the i-th edge of E gets id i.
+inline sdsl::int_vector<> edge_ids_identity(const sdsl::bit_vector& e)
+{
+    uint64_t edges = 0;
+    for (Index i = 0; i < e.size(); i++)
+        edges += e[i];
+    sdsl::int_vector<> ids(edges, 0);
+    for (Index i = 0; i < edges; i++)
+        ids[i] = i;
+    sdsl::util::bit_compress(ids);
+    return ids;
+}
+
+// Rank in E of each stable id, the inverse of ids. Deleted ids get ids.size(), and keep a stale rank once the modify
+// functions update the ranks, see edge_id_rank.
+inline sdsl::int_vector<> edge_id_ranks(const sdsl::int_vector<>& ids, uint64_t next_id)
+{
+    sdsl::int_vector<> ranks(next_id, ids.size());
+    for (Index i = 0; i < ids.size(); i++)
+        ranks[ids[i]] = i;
+    sdsl::util::bit_compress(ranks);
+    return ranks;
+}
+
+// The number of nodes of the i-th edge of E, i.e. the length of its cycle.
+template<class P>
+sdsl::int_vector<> edge_sizes(const P& psi, const sdsl::bit_vector& e)
+{
+    uint64_t edges = 0;
+    for (Index i = 0; i < e.size(); i++)
+        edges += e[i];
+    sdsl::int_vector<> sizes(edges, 0);
+    for (Index i = 0, edge = 0; i < e.size(); i++)
+    {
+        if (!e[i])
+            continue;
+        uint64_t size = 1;
+        for (Index j = psi[i]; j != i; j = psi[j])
+            size++;
+        sizes[edge++] = size;
+    }
+    sdsl::util::bit_compress(sizes);
+    return sizes;
+}
+
+// Histogram of the sizes, counts[k] is the number of edges with k nodes.
+inline std::vector<uint64_t> edge_size_counts(const sdsl::int_vector<>& sizes)
+{
+    std::vector<uint64_t> counts;
+    for (Index i = 0; i < sizes.size(); i++)
+    {
+        if (sizes[i] >= counts.size())
+            counts.resize(sizes[i] + 1, 0);
+        counts[sizes[i]]++;
+    }
+    return counts;
+}
+
 class CompressedHyperGraph {
 public:
+    typedef sdsl::rank_support_v<1> rank_1_type;
+    typedef sdsl::select_support_mcl<1> select_1_type;
+
     sdsl::bit_vector D;
     sdsl::enc_vector<> PSI;
+    sdsl::bit_vector E; // See edge_starts, kept up to date by construct and the modify functions.
+    // Stable id of the i-th edge of E. The modify functions keep the ids of the edges they do not delete, and a new
+    // edge gets next_id, so an id is never reused.
+    sdsl::int_vector<> ids;
+    uint64_t next_id;
+    sdsl::int_vector<> id_ranks; // See edge_id_ranks, derived from ids and kept up to date like them.
+
+    CompressedHyperGraph(sdsl::bit_vector d, const sdsl::enc_vector<>& psi) // E is derived from PSI.
+            : D(std::move(d)), PSI(psi), E(edge_starts(PSI)), ids(edge_ids_identity(E)), next_id(ids.size()),
+              id_ranks(edge_id_ranks(ids, next_id)) {}
+    CompressedHyperGraph(sdsl::bit_vector d, const sdsl::enc_vector<>& psi, sdsl::bit_vector e)
+            : D(std::move(d)), PSI(psi), E(std::move(e)), ids(edge_ids_identity(E)), next_id(ids.size()),
+              id_ranks(edge_id_ranks(ids, next_id)) {}
+    CompressedHyperGraph(sdsl::bit_vector d, const sdsl::enc_vector<>& psi, sdsl::bit_vector e,
+                         sdsl::int_vector<> i, uint64_t next)
+            : D(std::move(d)), PSI(psi), E(std::move(e)), ids(std::move(i)), next_id(next),
+              id_ranks(edge_id_ranks(ids, next_id)) {}
+};
+
+// Rank in E of the edge with the stable id, or -1 if the id was deleted. The rank of a deleted id is out of range or
+// holds another id, as ids are unique.
+inline Index edge_id_rank(const CompressedHyperGraph& g, Index id)
+{
+    if (id >= g.id_ranks.size() || g.id_ranks[id] >= g.ids.size() || g.ids[g.id_ranks[id]] != id)
+        return -1;
+    return g.id_ranks[id];
+}
+
+/*
+ * Dynamic backend with the same interface as CompressedHyperGraph for the queries.
+ * PSI is not stored, but derived from L, where L[j] is the node of the position i with PSI[i] = j.
+ * As PSI is increasing within each interval of D, PSI[i] is the (i - start + 1)-th occurrence of the node of i in L.
+ */
+class DynamicHyperGraph {
+public:
+    typedef DynamicRankSupport rank_1_type;
+    typedef DynamicSelectSupport select_1_type;
+
+    class Psi {
+        const DynamicHyperGraph *graph;
+    public:
+        explicit Psi(const DynamicHyperGraph *g) : graph(g) {}
+        Index operator[](Index i) const {
+            Node node = graph->D.rank1(i + 1) - 1;
+            return graph->L.select(node, i - graph->D.select1(node + 1) + 1);
+        }
+        Index size() const { return graph->L.size(); }
+    };
+
+    DynamicBitVector D;
+    DynamicSequence L;
+    Psi PSI;
+
+    DynamicHyperGraph(DynamicBitVector d, DynamicSequence l)
+            : D(std::move(d)), L(std::move(l)), PSI(this) {}
+    DynamicHyperGraph(const DynamicHyperGraph &other)
+            : D(other.D), L(other.L), PSI(this) {}
+    DynamicHyperGraph &operator=(const DynamicHyperGraph &other) {
+        D = other.D;
+        L = other.L;
+        return *this;
+    }
 
-    CompressedHyperGraph(sdsl::bit_vector d, const sdsl::enc_vector<>& psi)
-            : D(std::move(d)), PSI(psi) {}
+    // Inverse of PSI.
+    Index lf(Index j) const {
+        Node node = L[j];
+        return D.select1(node + 1) + L.rank(node, j);
+    }
 };
 
 class EdgeIterator {